@@ -0,0 +1,143 @@
+#include "alocacoes.hpp"
+
+#ifdef MACSLANG_CONTAR_ALOCACOES
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Cada bloco guarda o próprio tamanho antes do ponteiro devolvido, para que
+// o delete sem tamanho também consiga descontar a memória viva.
+constexpr size_t CABECALHO = alignof(std::max_align_t);
+
+std::atomic<size_t> alocacoes_[NUM_FASES];
+std::atomic<size_t> bytes_[NUM_FASES];
+std::atomic<size_t> vivos_{0};
+std::atomic<size_t> pico_{0};
+
+thread_local FaseAlocacao fase_atual_ = FASE_OUTRA;
+
+const char* nome_fase(FaseAlocacao fase) {
+    switch (fase) {
+        case FASE_OUTRA: return "outra";
+        case FASE_LEXER: return "lexer";
+        case FASE_PARSER: return "parser";
+        case FASE_ESCOPO: return "escopo";
+        case FASE_DIAGNOSTICO: return "diagnostico";
+        default: return "desconhecida";
+    }
+}
+
+void* aloca(size_t n) {
+    void* bloco = std::malloc(n + CABECALHO);
+    if (!bloco) {
+        return nullptr;
+    }
+    *static_cast<size_t*>(bloco) = n;
+
+    alocacoes_[fase_atual_].fetch_add(1, std::memory_order_relaxed);
+    bytes_[fase_atual_].fetch_add(n, std::memory_order_relaxed);
+    size_t vivos = vivos_.fetch_add(n, std::memory_order_relaxed) + n;
+    size_t pico = pico_.load(std::memory_order_relaxed);
+    while (vivos > pico && !pico_.compare_exchange_weak(pico, vivos, std::memory_order_relaxed)) {
+    }
+
+    return static_cast<char*>(bloco) + CABECALHO;
+}
+
+void libera(void* p) {
+    if (!p) {
+        return;
+    }
+    char* bloco = static_cast<char*>(p) - CABECALHO;
+    vivos_.fetch_sub(*reinterpret_cast<size_t*>(bloco), std::memory_order_relaxed);
+    std::free(bloco);
+}
+
+} // namespace
+
+EscopoFase::EscopoFase(FaseAlocacao fase) : anterior_(fase_atual_) {
+    fase_atual_ = fase;
+}
+
+EscopoFase::~EscopoFase() {
+    fase_atual_ = anterior_;
+}
+
+ContagemAlocacao contagem_alocacoes(FaseAlocacao fase) {
+    return {alocacoes_[fase].load(std::memory_order_relaxed), bytes_[fase].load(std::memory_order_relaxed)};
+}
+
+size_t pico_memoria_viva() {
+    return pico_.load(std::memory_order_relaxed);
+}
+
+void zerar_alocacoes() {
+    for (int f = 0; f < NUM_FASES; f++) {
+        alocacoes_[f].store(0, std::memory_order_relaxed);
+        bytes_[f].store(0, std::memory_order_relaxed);
+    }
+    pico_.store(vivos_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void relatorio_alocacoes(std::ostream& saida, size_t num_tokens) {
+    saida << "\n==== ALOCAÇÕES ====\n";
+    size_t total = 0;
+    for (int f = 0; f < NUM_FASES; f++) {
+        ContagemAlocacao c = contagem_alocacoes(static_cast<FaseAlocacao>(f));
+        total += c.alocacoes;
+        saida << nome_fase(static_cast<FaseAlocacao>(f)) << ": " << c.alocacoes << " alocações, " << c.bytes << " bytes\n";
+    }
+    saida << "pico de memória viva: " << pico_memoria_viva() << " bytes\n";
+    if (num_tokens > 0) {
+        saida << "alocações por token: " << static_cast<double>(total) / num_tokens << "\n";
+    }
+}
+
+void* operator new(std::size_t n) {
+    void* p = aloca(n);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t n) {
+    return operator new(n);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    return aloca(n);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    return aloca(n);
+}
+
+void operator delete(void* p) noexcept {
+    libera(p);
+}
+
+void operator delete[](void* p) noexcept {
+    libera(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    libera(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    libera(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    libera(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    libera(p);
+}
+
+#endif
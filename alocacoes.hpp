@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+
+// Contabilidade opcional de alocações no heap, por fase do compilador.
+// Só fica ativa quando compilado com -DMACSLANG_CONTAR_ALOCACOES, que
+// substitui os operator new/delete globais (veja alocacoes.cpp).
+
+enum FaseAlocacao {
+    FASE_OUTRA,
+    FASE_LEXER,
+    FASE_PARSER,
+    FASE_ESCOPO,
+    FASE_DIAGNOSTICO,
+    NUM_FASES
+};
+
+struct ContagemAlocacao {
+    size_t alocacoes;
+    size_t bytes;
+};
+
+#ifdef MACSLANG_CONTAR_ALOCACOES
+
+// Atribui as alocações da thread atual a `fase` enquanto o objeto existir
+class EscopoFase {
+public:
+    explicit EscopoFase(FaseAlocacao fase);
+    ~EscopoFase();
+    EscopoFase(const EscopoFase&) = delete;
+    EscopoFase& operator=(const EscopoFase&) = delete;
+
+private:
+    FaseAlocacao anterior_;
+};
+
+ContagemAlocacao contagem_alocacoes(FaseAlocacao fase);
+size_t pico_memoria_viva();
+void zerar_alocacoes();
+void relatorio_alocacoes(std::ostream& saida, size_t num_tokens);
+
+#else
+
+class EscopoFase {
+public:
+    explicit EscopoFase(FaseAlocacao) {}
+};
+
+inline ContagemAlocacao contagem_alocacoes(FaseAlocacao) { return {0, 0}; }
+inline size_t pico_memoria_viva() { return 0; }
+inline void zerar_alocacoes() {}
+inline void relatorio_alocacoes(std::ostream&, size_t) {}
+
+#endif
@@ -0,0 +1,96 @@
+// Benchmark de chamadas de função no interpretador, com e sem a expansão
+// de funções folha. MacsLang ainda não tem aritmética, então não dá para
+// escrever fib; no lugar dela, cada volta do laço desce uma cadeia de
+// funções que chamam uma folha em cada nível.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. bench/bench_chamadas.cpp $(ls *.cpp | grep -v '^main.cpp$') -o bench_chamadas
+//   ./bench_chamadas [voltas=200000] [profundidade=20]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "interpretador.hpp"
+
+namespace {
+
+// Cada f<i> chama a folha e depois f<i+1>; a última chama a folha de novo.
+// O laço principal roda até input(continua) ler false.
+std::string gera_programa(int profundidade) {
+    std::string codigo = "func folha(x: int): int {\n    return x;\n}\n";
+    for (int i = profundidade - 1; i >= 0; i--) {
+        std::string proxima = i + 1 == profundidade ? "folha" : "f" + std::to_string(i + 1);
+        codigo += "func f" + std::to_string(i) + "(x: int): int {\n";
+        codigo += "    var a: int = folha(x);\n";
+        codigo += "    var b: int = " + proxima + "(a);\n";
+        codigo += "    return b;\n}\n";
+    }
+    codigo += "var continua: bool = true;\n";
+    codigo += "while (continua) {\n    var v: int = f0(1);\n    input(continua);\n}\nprint(continua);\n";
+    return codigo;
+}
+
+struct Medida {
+    double segundos;
+    size_t chamadas_restantes; // OP_CHAMA no código depois da expansão
+    std::string saida;
+};
+
+bool mede(const std::string& codigo, bool expandir, int voltas, Medida& medida) {
+    std::vector<Diagnostico> diagnosticos;
+    OpcoesCompilacao opcoes;
+    opcoes.expandir_folhas = expandir;
+    std::shared_ptr<const Programa> programa = compilar(codigo, diagnosticos, opcoes);
+    if (!programa) {
+        for (const Diagnostico& d : diagnosticos) {
+            std::fprintf(stderr, "Linha %d: %s\n", d.linha, d.mensagem.c_str());
+        }
+        return false;
+    }
+
+    medida.chamadas_restantes = 0;
+    for (const Instrucao& instrucao : programa->codigo) {
+        medida.chamadas_restantes += instrucao.op == OP_CHAMA;
+    }
+
+    Processo processo(programa, 1u << 30);
+    for (int i = 0; i < voltas; i++) {
+        processo.fornecer_entrada(i + 1 == voltas ? "false" : "true");
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    while (processo.continuar() == PROCESSO_PRONTO) {
+    }
+    medida.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    medida.saida = processo.saida() + processo.erro();
+    return processo.estado() == PROCESSO_TERMINADO && processo.erro().empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int voltas = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int profundidade = argc > 2 ? std::atoi(argv[2]) : 20;
+    std::string codigo = gera_programa(profundidade);
+
+    // Chamadas escritas no código executadas por volta: a cadeia, uma folha
+    // em cada nível e a folha final
+    double chamadas = static_cast<double>(voltas) * (2 * profundidade + 1);
+
+    Medida sem, com;
+    if (!mede(codigo, false, voltas, sem) || !mede(codigo, true, voltas, com)) {
+        return 1;
+    }
+    if (sem.saida != com.saida) {
+        std::fprintf(stderr, "Saídas diferentes com e sem expansão\n");
+        return 1;
+    }
+
+    std::printf("voltas: %d, profundidade: %d, chamadas no código-fonte: %.0f\n", voltas, profundidade, chamadas);
+    std::printf("sem expansão: %.3f s, %.1f M chamadas/s (%zu OP_CHAMA no código)\n", sem.segundos,
+                chamadas / sem.segundos / 1e6, sem.chamadas_restantes);
+    std::printf("com expansão: %.3f s, %.1f M chamadas/s (%zu OP_CHAMA no código)\n", com.segundos,
+                chamadas / com.segundos / 1e6, com.chamadas_restantes);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Benchmark do Escalonador: muitos Processos esperando input ao mesmo tempo.
+// Mede trocas de contexto por segundo e memória por instância.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. bench/bench_escalonador.cpp $(ls *.cpp | grep -v '^main.cpp$') -o bench_escalonador
+//   ./bench_escalonador [instâncias=100000] [threads=0] [rodadas=3]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "escalonador.hpp"
+
+namespace {
+
+// Memória residente do processo em KiB, lida de /proc (só Linux)
+long memoria_residente() {
+    std::ifstream status("/proc/self/status");
+    std::string linha;
+    while (std::getline(status, linha)) {
+        if (linha.rfind("VmRSS:", 0) == 0) {
+            return std::stol(linha.substr(6));
+        }
+    }
+    return 0;
+}
+
+// Cada instância para no input a cada volta do laço, até receber 0
+const char* const PROGRAMA =
+    "var x: int = 1;\n"
+    "while (x) {\n"
+    "    input(x);\n"
+    "    var y: int = x;\n"
+    "}\n"
+    "print(x);\n";
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int instancias = argc > 1 ? std::atoi(argv[1]) : 100000;
+    unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 0;
+    int rodadas = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    std::vector<Diagnostico> diagnosticos;
+    std::shared_ptr<const Programa> programa = compilar(PROGRAMA, diagnosticos);
+    if (!programa) {
+        for (const Diagnostico& d : diagnosticos) {
+            std::fprintf(stderr, "Linha %d: %s\n", d.linha, d.mensagem.c_str());
+        }
+        return 1;
+    }
+
+    Escalonador escalonador(threads);
+    std::vector<Processo*> processos;
+    processos.reserve(instancias);
+
+    long antes = memoria_residente();
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < instancias; i++) {
+        processos.push_back(&escalonador.criar(programa, 4));
+    }
+    escalonador.aguardar(); // todos parados no primeiro input
+    long depois = memoria_residente();
+
+    for (int r = 0; r < rodadas; r++) {
+        const char* entrada = r + 1 == rodadas ? "0" : "5";
+        for (Processo* p : processos) {
+            escalonador.fornecer_entrada(*p, entrada);
+        }
+        escalonador.aguardar();
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    size_t terminados = 0;
+    for (Processo* p : processos) {
+        terminados += p->estado() == PROCESSO_TERMINADO;
+        escalonador.remover(*p);
+    }
+
+    uint64_t trocas = escalonador.trocas_de_contexto();
+    std::printf("instancias: %d (terminados: %zu, restantes após remover: %zu)\n", instancias, terminados,
+                escalonador.num_processos());
+    std::printf("trocas de contexto: %llu em %.3f s = %.0f/s\n", static_cast<unsigned long long>(trocas), segundos,
+                trocas / segundos);
+    std::printf("memória por instância: %.0f bytes\n", (depois - antes) * 1024.0 / instancias);
+    return terminados == static_cast<size_t>(instancias) && escalonador.num_processos() == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+// Benchmark do cache de módulos: uma biblioteca grande importada por muitos
+// arquivos. Mede a validação de todos eles em threads separadas três vezes:
+// com o cache desligado (todo arquivo compila a biblioteca), com o cache
+// ligado mas vazio (vários compiladores gravam o mesmo resumo ao mesmo
+// tempo) e com o cache já gravado (todo arquivo lê o resumo).
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. bench/bench_modulos.cpp $(ls *.cpp | grep -v '^main.cpp$') -o bench_modulos
+//   ./bench_modulos [funções da biblioteca=5000] [arquivos=64] [threads=8]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lexer.hpp"
+#include "modulos.hpp"
+#include "parser.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string gera_biblioteca(int funcoes) {
+    std::string codigo;
+    for (int i = 0; i < funcoes; i++) {
+        std::string n = std::to_string(i);
+        codigo += "var g" + n + ": int = " + n + ";\n";
+        codigo += "func f" + n + "(a: int, b: string): int {\n"
+                  "    print(b);\n"
+                  "    return a;\n"
+                  "}\n";
+    }
+    return codigo;
+}
+
+std::string gera_arquivo(int indice, int funcoes) {
+    std::string codigo = "import \"biblioteca.macslang\";\n";
+    for (int i = 0; i < 20; i++) {
+        std::string n = std::to_string((indice * 31 + i * 7) % funcoes);
+        codigo += "var v" + std::to_string(i) + ": int = f" + n + "(g" + n + ", \"x\");\n";
+    }
+    return codigo;
+}
+
+// Valida cada arquivo com o próprio carregador, como compiladores
+// independentes; devolve o tempo total em milissegundos
+double valida_todos(const std::vector<std::string>& arquivos, const fs::path& diretorio, unsigned threads,
+                    bool usar_cache, size_t& resumos_usados, int& falhas) {
+    std::atomic<size_t> proximo{0};
+    std::atomic<size_t> resumos{0};
+    std::atomic<int> erros{0};
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<std::thread> trabalhadores;
+    for (unsigned t = 0; t < threads; t++) {
+        trabalhadores.emplace_back([&] {
+            for (size_t i = proximo++; i < arquivos.size(); i = proximo++) {
+                Lexer lexer(arquivos[i]);
+                std::vector<Token> tokens;
+                do {
+                    tokens.push_back(lexer.proximo_token());
+                } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+
+                CarregadorModulos modulos;
+                modulos.usar_cache(usar_cache);
+                Parser parser(std::move(tokens));
+                parser.usarSaida(false);
+                parser.usarModulos(&modulos, diretorio.string());
+                if (!parser.parse()) {
+                    erros++;
+                }
+                resumos += modulos.resumos_usados();
+            }
+        });
+    }
+    for (std::thread& t : trabalhadores) {
+        t.join();
+    }
+    auto fim = std::chrono::steady_clock::now();
+
+    resumos_usados = resumos;
+    falhas = erros;
+    return std::chrono::duration<double, std::milli>(fim - inicio).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int funcoes = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int num_arquivos = argc > 2 ? std::atoi(argv[2]) : 64;
+    unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 8;
+
+    fs::path diretorio = fs::temp_directory_path() / ("macslang_bench_modulos_" + std::to_string(std::random_device{}()));
+    fs::create_directories(diretorio);
+    std::ofstream(diretorio / "biblioteca.macslang") << gera_biblioteca(funcoes);
+
+    std::vector<std::string> arquivos;
+    for (int i = 0; i < num_arquivos; i++) {
+        arquivos.push_back(gera_arquivo(i, funcoes));
+    }
+
+    std::printf("biblioteca: %d funções, %d arquivos, %u threads\n", funcoes, num_arquivos, threads);
+    struct Rodada {
+        const char* nome;
+        bool usar_cache;
+    };
+    const Rodada rodadas[] = {{"sem cache", false}, {"cache vazio", true}, {"com cache", true}};
+    int falhas_total = 0;
+    bool resumos_esperados = true;
+    for (const Rodada& rodada : rodadas) {
+        size_t resumos = 0;
+        int falhas = 0;
+        double ms = valida_todos(arquivos, diretorio, threads, rodada.usar_cache, resumos, falhas);
+        std::printf("%-11s %9.1f ms  %7.2f ms/arquivo  resumos usados: %zu  falhas: %d\n", rodada.nome, ms,
+                    ms / num_arquivos, resumos, falhas);
+        falhas_total += falhas;
+        // Sem cache nada pode ser lido; com ele já gravado, tudo
+        if (&rodada == &rodadas[0] && resumos != 0) {
+            resumos_esperados = false;
+        }
+        if (&rodada == &rodadas[2] && resumos != arquivos.size()) {
+            resumos_esperados = false;
+        }
+    }
+    if (!resumos_esperados) {
+        std::fprintf(stderr, "número de resumos usados não bate com a rodada\n");
+    }
+
+    // Nenhum temporário pode sobrar, nem com vários gravando o mesmo resumo
+    size_t temporarios = 0;
+    for (const auto& entrada : fs::directory_iterator(diretorio / ".macslang_cache")) {
+        temporarios += entrada.path().extension() == ".tmp";
+    }
+    std::printf("temporários restantes: %zu\n", temporarios);
+
+    std::error_code ec;
+    fs::remove_all(diretorio, ec);
+    return falhas_total == 0 && temporarios == 0 && resumos_esperados ? 0 : 1;
+}
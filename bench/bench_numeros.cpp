@@ -0,0 +1,65 @@
+// Benchmark do Lexer em código cheio de números: inteiros, reais curtos,
+// reais com muitas casas e reais pequenos demais para um double (que viram
+// 0). Mede tokens e megabytes por segundo só da análise léxica.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. bench/bench_numeros.cpp $(ls *.cpp | grep -v '^main.cpp$') -o bench_numeros
+//   ./bench_numeros [declarações=500000] [rodadas=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "lexer.hpp"
+
+namespace {
+
+std::string gera_programa(int declaracoes) {
+    const std::string minusculo = "0." + std::string(330, '0') + "1";
+    std::string codigo;
+    for (int i = 0; i < declaracoes; i++) {
+        std::string n = std::to_string(i);
+        switch (i % 4) {
+            case 0: codigo += "var i" + n + ": int = " + std::to_string(i * 7919LL) + ";\n"; break;
+            case 1: codigo += "var r" + n + ": float = " + n + ".25;\n"; break;
+            case 2: codigo += "var p" + n + ": float = 3.14159265358979323846264338327950288;\n"; break;
+            default: codigo += "var m" + n + ": float = " + (i % 64 == 3 ? minusculo : "0.000001") + ";\n"; break;
+        }
+    }
+    return codigo;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int declaracoes = argc > 1 ? std::atoi(argv[1]) : 500000;
+    int rodadas = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string codigo = gera_programa(declaracoes);
+
+    double melhor = 1e30;
+    size_t tokens = 0;
+    size_t numeros = 0;
+    bool erro = false;
+    Lexer lexer(codigo);
+    for (int r = 0; r < rodadas; r++) {
+        lexer.reiniciar(codigo);
+        tokens = 0;
+        numeros = 0;
+        auto inicio = std::chrono::steady_clock::now();
+        for (Token t = lexer.proximo_token(); t.tipo != FIM_ARQUIVO; t = lexer.proximo_token()) {
+            if (t.tipo == ERRO) {
+                std::fprintf(stderr, "erro léxico: %s\n", t.valor.c_str());
+                erro = true;
+                break;
+            }
+            tokens++;
+            numeros += t.tipo == NUMERO_INTEIRO || t.tipo == NUMERO_REAL;
+        }
+        melhor = std::min(melhor, std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+    }
+
+    std::printf("arquivo: %zu bytes, %zu tokens, %zu números (melhor de %d)\n", codigo.size(), tokens, numeros, rodadas);
+    std::printf("%.1f ms  %.1f M tokens/s  %.1f MB/s\n", melhor * 1e3, tokens / melhor / 1e6,
+                codigo.size() / melhor / 1e6);
+    return erro ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Benchmark do modo pipeline: compara o Lexer inteiro seguido do Parser
+// (como compila_sequencial) com o Lexer numa thread entregando tokens ao
+// Parser por um CanalTokens (como compila_pipeline), num arquivo grande
+// gerado. O Parser roda sem saída nos dois casos.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. bench/bench_pipeline.cpp $(ls *.cpp | grep -v '^main.cpp$') -o bench_pipeline
+//   ./bench_pipeline [comandos=200000] [rodadas=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "canal_tokens.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+
+namespace {
+
+// Declarações, prints, ifs e whiles, todos válidos
+std::string gera_programa(int comandos) {
+    std::string codigo = "var c: bool = true;\nvar s: string = \"texto\";\n";
+    for (int i = 0; i < comandos; i++) {
+        std::string n = std::to_string(i);
+        switch (i % 4) {
+            case 0: codigo += "var v" + n + ": float = " + n + ".5;\n"; break;
+            case 1: codigo += "print(s);\n"; break;
+            case 2: codigo += "if (c) {\n    print(\"" + n + "\");\n} else {\n    print(s);\n}\n"; break;
+            default: codigo += "while (c) {\n    var w: int = " + n + ";\n    input(c);\n}\n"; break;
+        }
+    }
+    return codigo;
+}
+
+bool sequencial(const std::string& codigo, size_t& num_tokens) {
+    Lexer lexer(codigo);
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(lexer.proximo_token());
+    } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+    num_tokens = tokens.size();
+
+    Parser parser(std::move(tokens));
+    parser.usarSaida(false);
+    return parser.parse();
+}
+
+bool pipeline(const std::string& codigo, size_t& num_tokens) {
+    CanalTokens canal;
+    size_t enviados = 0;
+    std::thread produtor([&] {
+        Lexer lexer(codigo);
+        for (;;) {
+            Token token = lexer.proximo_token();
+            bool ultimo = token.tipo == FIM_ARQUIVO || token.tipo == ERRO;
+            enviados++;
+            if (!canal.enviar(std::move(token)) || ultimo) {
+                break;
+            }
+        }
+        canal.fechar();
+    });
+
+    Parser parser(canal);
+    parser.usarSaida(false);
+    bool correto = parser.parse();
+    canal.cancelar();
+    produtor.join();
+    num_tokens = enviados;
+    return correto;
+}
+
+// Menor tempo entre as rodadas, em segundos
+template <typename Compila>
+double mede(Compila compila, const std::string& codigo, int rodadas, size_t& num_tokens, bool& correto) {
+    double melhor = 1e30;
+    for (int i = 0; i < rodadas; i++) {
+        auto inicio = std::chrono::steady_clock::now();
+        correto = compila(codigo, num_tokens);
+        melhor = std::min(melhor, std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+    }
+    return melhor;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int comandos = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int rodadas = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string codigo = gera_programa(comandos);
+
+    size_t tokens_sequencial = 0, tokens_pipeline = 0;
+    bool correto_sequencial = false, correto_pipeline = false;
+    double t_sequencial = mede(sequencial, codigo, rodadas, tokens_sequencial, correto_sequencial);
+    double t_pipeline = mede(pipeline, codigo, rodadas, tokens_pipeline, correto_pipeline);
+
+    std::printf("arquivo: %zu bytes, %zu tokens (melhor de %d)\n", codigo.size(), tokens_sequencial, rodadas);
+    std::printf("sequencial %8.1f ms  %6.1f M tokens/s\n", t_sequencial * 1e3, tokens_sequencial / t_sequencial / 1e6);
+    std::printf("pipeline   %8.1f ms  %6.1f M tokens/s\n", t_pipeline * 1e3, tokens_pipeline / t_pipeline / 1e6);
+    std::printf("ganho      %8.2fx\n", t_sequencial / t_pipeline);
+
+    bool ok = correto_sequencial && correto_pipeline && tokens_sequencial == tokens_pipeline;
+    if (!ok) {
+        std::fprintf(stderr, "os dois modos não concordam\n");
+    }
+    return ok ? 0 : 1;
+}
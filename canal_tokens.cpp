@@ -0,0 +1,70 @@
+#include "canal_tokens.hpp"
+#include <thread>
+
+CanalTokens::CanalTokens(size_t capacidade) {
+    size_t tamanho = LOTE;
+    while (tamanho < capacidade) {
+        tamanho *= 2;
+    }
+    buffer_.resize(tamanho);
+    mascara_ = tamanho - 1;
+}
+
+bool CanalTokens::enviar(Token&& token) {
+    while (escrita_local_ - leitura_vista_ == buffer_.size()) {
+        // Cheia: publica o lote parcial antes de esperar, senão o
+        // consumidor poderia ficar esperando pelos mesmos tokens
+        escrita_.store(escrita_local_, std::memory_order_release);
+        leitura_vista_ = leitura_.load(std::memory_order_acquire);
+        if (escrita_local_ - leitura_vista_ != buffer_.size()) {
+            break;
+        }
+        if (cancelado_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    buffer_[escrita_local_ & mascara_] = std::move(token);
+    escrita_local_++;
+    if (escrita_local_ % LOTE == 0) {
+        escrita_.store(escrita_local_, std::memory_order_release);
+    }
+    return !cancelado_.load(std::memory_order_relaxed);
+}
+
+void CanalTokens::fechar() {
+    escrita_.store(escrita_local_, std::memory_order_release);
+    fechado_.store(true, std::memory_order_release);
+}
+
+bool CanalTokens::receber(Token& token) {
+    while (leitura_local_ == escrita_vista_) {
+        // Vazia: devolve as posições já lidas e busca o próximo lote
+        leitura_.store(leitura_local_, std::memory_order_release);
+        escrita_vista_ = escrita_.load(std::memory_order_acquire);
+        if (leitura_local_ != escrita_vista_) {
+            break;
+        }
+        if (fechado_.load(std::memory_order_acquire)) {
+            // Relê: o produtor publica a escrita antes de marcar o fechamento
+            escrita_vista_ = escrita_.load(std::memory_order_acquire);
+            if (leitura_local_ == escrita_vista_) {
+                return false;
+            }
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    token = std::move(buffer_[leitura_local_ & mascara_]);
+    leitura_local_++;
+    if (leitura_local_ % LOTE == 0) {
+        leitura_.store(leitura_local_, std::memory_order_release);
+    }
+    return true;
+}
+
+void CanalTokens::cancelar() {
+    cancelado_.store(true, std::memory_order_relaxed);
+}
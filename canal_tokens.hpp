@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "token.hpp"
+
+// Fila circular sem locks com um único produtor (thread do Lexer) e um único
+// consumidor (Parser). Os índices de escrita e leitura ficam em linhas de
+// cache separadas e só são publicados a cada LOTE tokens, para que as duas
+// threads não disputem a mesma linha a cada token.
+class CanalTokens {
+public:
+    static constexpr size_t LOTE = 64;
+
+    explicit CanalTokens(size_t capacidade = 4096); // arredondada para potência de 2
+
+    // Produtor: espera enquanto a fila estiver cheia (contrapressão).
+    // Devolve false se o consumidor cancelou o canal.
+    bool enviar(Token&& token);
+    // Produtor: publica o que falta e sinaliza fim do fluxo
+    void fechar();
+
+    // Consumidor: espera até haver token. Devolve false quando o canal foi
+    // fechado e não resta nada para ler.
+    bool receber(Token& token);
+    // Consumidor: libera o produtor caso o parser pare antes do fim
+    void cancelar();
+
+private:
+    static constexpr size_t LINHA_CACHE = 64;
+
+    std::vector<Token> buffer_;
+    size_t mascara_;
+
+    alignas(LINHA_CACHE) std::atomic<size_t> escrita_{0};
+    alignas(LINHA_CACHE) std::atomic<size_t> leitura_{0};
+    alignas(LINHA_CACHE) std::atomic<bool> fechado_{false};
+    std::atomic<bool> cancelado_{false};
+
+    // Estado privado do produtor
+    alignas(LINHA_CACHE) size_t escrita_local_ = 0;
+    size_t leitura_vista_ = 0;
+
+    // Estado privado do consumidor
+    alignas(LINHA_CACHE) size_t leitura_local_ = 0;
+    size_t escrita_vista_ = 0;
+};
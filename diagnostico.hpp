@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+
+enum TipoDiagnostico {
+    DIAGNOSTICO_LEXICO,
+    DIAGNOSTICO_SINTATICO
+};
+
+// Erro encontrado ao validar um programa, com a linha onde ocorreu
+struct Diagnostico {
+    TipoDiagnostico tipo;
+    int linha;
+    std::string mensagem;
+};
@@ -0,0 +1,170 @@
+#include "escalonador.hpp"
+#include <algorithm>
+
+namespace {
+
+// Fila da thread de trabalho atual; fora delas, nenhuma
+thread_local int fila_da_thread_ = -1;
+
+} // namespace
+
+Escalonador::Escalonador(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        filas_.push_back(std::make_unique<Fila>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        threads_.emplace_back(&Escalonador::trabalha, this, i);
+    }
+}
+
+Escalonador::~Escalonador() {
+    {
+        std::lock_guard<std::mutex> trava(trava_);
+        encerrando_ = true;
+    }
+    tem_trabalho_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+Processo& Escalonador::criar(std::shared_ptr<const Programa> programa, uint32_t orcamento, Perfil* perfil) {
+    auto novo = std::make_unique<Processo>(std::move(programa), orcamento, perfil);
+    Processo* processo = novo.get();
+    {
+        std::lock_guard<std::mutex> trava(trava_processos_);
+        processos_.emplace(processo, std::move(novo));
+    }
+    pendentes_++;
+    agenda(processo, true);
+    return *processo;
+}
+
+void Escalonador::fornecer_entrada(Processo& processo, std::string linha) {
+    std::lock_guard<std::mutex> trava(trava_processos_);
+    processo.fornecer_entrada(std::move(linha));
+    if (estacionados_.erase(&processo)) {
+        pendentes_++;
+        agenda(&processo, true);
+    }
+}
+
+bool Escalonador::remover(Processo& processo) {
+    std::unique_ptr<Processo> removido;
+    {
+        std::lock_guard<std::mutex> trava(trava_processos_);
+        // Estacionado: fora das filas até fornecer_entrada(). Terminado: a
+        // thread que o rodou não volta a tocar nele.
+        if (!estacionados_.erase(&processo) && processo.estado() != PROCESSO_TERMINADO) {
+            return false;
+        }
+        auto it = processos_.find(&processo);
+        if (it == processos_.end()) {
+            return false;
+        }
+        removido = std::move(it->second);
+        processos_.erase(it);
+    }
+    return true; // destruído aqui, fora da trava
+}
+
+size_t Escalonador::num_processos() const {
+    std::lock_guard<std::mutex> trava(trava_processos_);
+    return processos_.size();
+}
+
+void Escalonador::aguardar() {
+    std::unique_lock<std::mutex> trava(trava_);
+    ocioso_.wait(trava, [this] { return pendentes_.load() == 0; });
+}
+
+uint64_t Escalonador::trocas_de_contexto() const {
+    return trocas_.load(std::memory_order_relaxed);
+}
+
+void Escalonador::agenda(Processo* processo, bool acordar) {
+    unsigned indice = fila_da_thread_ >= 0 ? static_cast<unsigned>(fila_da_thread_)
+                                            : proxima_fila_.fetch_add(1, std::memory_order_relaxed) % filas_.size();
+    {
+        std::lock_guard<std::mutex> trava(filas_[indice]->trava);
+        filas_[indice]->processos.push_back(processo);
+    }
+    na_fila_++;
+
+    // Só paga a trava quando há thread dormindo. Quem dorme incrementa
+    // dormindo_ antes de olhar na_fila_, e aqui na_fila_ muda antes de olhar
+    // dormindo_, então um dos dois lados sempre vê o outro.
+    if (acordar && dormindo_.load() > 0) {
+        { std::lock_guard<std::mutex> trava(trava_); }
+        tem_trabalho_.notify_one();
+    }
+}
+
+Processo* Escalonador::proximo(unsigned fila) {
+    {
+        Fila& propria = *filas_[fila];
+        std::lock_guard<std::mutex> trava(propria.trava);
+        if (!propria.processos.empty()) {
+            Processo* processo = propria.processos.front();
+            propria.processos.pop_front();
+            na_fila_--;
+            return processo;
+        }
+    }
+
+    for (size_t i = 1; i < filas_.size(); i++) {
+        Fila& vitima = *filas_[(fila + i) % filas_.size()];
+        std::lock_guard<std::mutex> trava(vitima.trava);
+        if (!vitima.processos.empty()) {
+            Processo* processo = vitima.processos.back();
+            vitima.processos.pop_back();
+            na_fila_--;
+            return processo;
+        }
+    }
+    return nullptr;
+}
+
+void Escalonador::trabalha(unsigned fila) {
+    fila_da_thread_ = static_cast<int>(fila);
+
+    for (;;) {
+        Processo* processo = proximo(fila);
+        if (!processo) {
+            std::unique_lock<std::mutex> trava(trava_);
+            dormindo_++;
+            tem_trabalho_.wait(trava, [this] { return encerrando_ || na_fila_.load() > 0; });
+            dormindo_--;
+            if (encerrando_) {
+                return;
+            }
+            continue;
+        }
+
+        trocas_.fetch_add(1, std::memory_order_relaxed);
+        EstadoProcesso estado = processo->continuar();
+
+        if (estado == PROCESSO_PRONTO) {
+            // Volta para a própria fila; outras threads ociosas podem roubá-lo
+            agenda(processo, true);
+            continue;
+        }
+
+        if (estado == PROCESSO_AGUARDANDO_ENTRADA) {
+            std::lock_guard<std::mutex> trava(trava_processos_);
+            if (processo->tem_entrada()) {
+                agenda(processo, false);
+                continue;
+            }
+            estacionados_.insert(processo);
+        }
+
+        if (--pendentes_ == 0) {
+            { std::lock_guard<std::mutex> trava(trava_); }
+            ocioso_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "interpretador.hpp"
+
+// Executa muitos Processos ao mesmo tempo num conjunto fixo de threads.
+// Cada thread tem a própria fila: tira processos da frente dela e, quando
+// fica sem trabalho, rouba do fim da fila das outras. Um processo volta para
+// a fila ao esgotar o orçamento e fica estacionado, fora de todas as filas,
+// enquanto espera uma entrada.
+class Escalonador {
+public:
+    explicit Escalonador(unsigned threads = 0); // 0: hardware_concurrency()
+    ~Escalonador();
+    Escalonador(const Escalonador&) = delete;
+    Escalonador& operator=(const Escalonador&) = delete;
+
+    // O Processo pertence ao Escalonador e vive até remover() ou até o
+    // Escalonador ser destruído. Com `perfil`, a execução é registrada nele
+    // (veja Processo).
+    Processo& criar(std::shared_ptr<const Programa> programa, uint32_t orcamento = 1000, Perfil* perfil = nullptr);
+    void fornecer_entrada(Processo& processo, std::string linha);
+
+    // Libera um processo que terminou ou que está parado esperando entrada.
+    // Devolve false, sem liberar nada, se ele ainda está numa fila ou rodando.
+    bool remover(Processo& processo);
+    size_t num_processos() const;
+
+    // Bloqueia até todo processo ter terminado ou estar esperando entrada
+    void aguardar();
+
+    uint64_t trocas_de_contexto() const;
+
+private:
+    struct Fila {
+        std::mutex trava;
+        std::deque<Processo*> processos;
+    };
+
+    std::vector<std::unique_ptr<Fila>> filas_;
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex trava_processos_;
+    std::unordered_map<Processo*, std::unique_ptr<Processo>> processos_;
+    std::unordered_set<Processo*> estacionados_; // esperando entrada, fora das filas
+
+    std::mutex trava_;
+    std::condition_variable tem_trabalho_;
+    std::condition_variable ocioso_;
+    bool encerrando_ = false;
+
+    std::atomic<size_t> na_fila_{0};    // processos em alguma fila
+    std::atomic<size_t> pendentes_{0};  // na fila ou rodando
+    std::atomic<unsigned> dormindo_{0}; // threads esperando em tem_trabalho_
+    std::atomic<uint64_t> trocas_{0};
+    std::atomic<unsigned> proxima_fila_{0};
+
+    void agenda(Processo* processo, bool acordar);
+    Processo* proximo(unsigned fila);
+    void trabalha(unsigned fila);
+};
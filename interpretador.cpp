@@ -0,0 +1,288 @@
+#include "interpretador.hpp"
+#include <algorithm>
+#include <charconv>
+#include "lexer.hpp"
+#include "modulos.hpp"
+#include "parser.hpp"
+
+namespace {
+
+bool verdadeiro(const Valor& v) {
+    switch (v.index()) {
+        case 0: return std::get<int64_t>(v) != 0;
+        case 1: return std::get<double>(v) != 0.0;
+        case 2: return std::get<char>(v) != '\0';
+        case 3: return std::get<bool>(v);
+        default: return !std::get<std::string>(v).empty();
+    }
+}
+
+} // namespace
+
+std::shared_ptr<const Programa> compilar(std::string_view codigo, std::vector<Diagnostico>& diagnosticos,
+                                         const OpcoesCompilacao& opcoes) {
+    Lexer lexer(codigo);
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(lexer.proximo_token());
+    } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+
+    if (tokens.back().tipo == ERRO) {
+        diagnosticos.push_back({DIAGNOSTICO_LEXICO, tokens.back().linha, tokens.back().valor});
+        return nullptr;
+    }
+
+    // O Parser valida e gera o código numa passada só, inclusive o dos
+    // módulos importados
+    auto programa = std::make_shared<Programa>();
+    CarregadorModulos modulos;
+    Parser parser(std::move(tokens));
+    parser.usarSaida(false);
+    parser.usarModulos(&modulos, opcoes.diretorio);
+    parser.usarPrograma(programa.get(), opcoes.expandir_folhas);
+    if (!parser.parse()) {
+        diagnosticos = parser.diagnosticos();
+        return nullptr;
+    }
+    programa->codigo.push_back({OP_FIM});
+    programa->bloco_instrucao.push_back(0);
+    programa->linha_instrucao.push_back(0);
+    for (const FuncaoCompilada& funcao : programa->funcoes) {
+        programa->maior_quadro = std::max(programa->maior_quadro, funcao.num_locais);
+    }
+    return programa;
+}
+
+Processo::Processo(std::shared_ptr<const Programa> programa, uint32_t orcamento, Perfil* perfil)
+    : programa_(std::move(programa)), orcamento_(orcamento == 0 ? 1 : orcamento), perfil_(perfil) {
+    pilha_.resize(programa_->num_globais);
+    topo_ = programa_->num_globais;
+    if (!programa_->funcoes.empty()) {
+        pilha_.resize(topo_ + programa_->maior_quadro);
+        quadros_.resize(QUADROS_INICIAIS);
+    }
+    tarefa_ = perfil_ ? executar<true>() : executar<false>();
+}
+
+Processo::~Processo() {
+    tarefa_.handle.destroy();
+}
+
+EstadoProcesso Processo::continuar() {
+    if (estado_.load(std::memory_order_acquire) == PROCESSO_TERMINADO) {
+        return PROCESSO_TERMINADO;
+    }
+
+    tarefa_.handle.resume();
+    if (tarefa_.handle.done()) {
+        if (tarefa_.handle.promise().excecao) {
+            erro_ = "Falha interna na execução";
+        }
+        estado_.store(PROCESSO_TERMINADO, std::memory_order_release);
+        return PROCESSO_TERMINADO;
+    }
+    return estado_.load(std::memory_order_relaxed);
+}
+
+void Processo::fornecer_entrada(std::string linha) {
+    std::lock_guard<std::mutex> trava(trava_entradas_);
+    entradas_.push_back(std::move(linha));
+}
+
+bool Processo::tem_entrada() const {
+    std::lock_guard<std::mutex> trava(trava_entradas_);
+    return proxima_entrada_ < entradas_.size();
+}
+
+bool Processo::proxima_linha(std::string& linha) {
+    std::lock_guard<std::mutex> trava(trava_entradas_);
+    if (proxima_entrada_ == entradas_.size()) {
+        return false;
+    }
+    linha = std::move(entradas_[proxima_entrada_++]);
+    return true;
+}
+
+EstadoProcesso Processo::estado() const {
+    return estado_.load(std::memory_order_acquire);
+}
+
+const std::string& Processo::saida() const {
+    return saida_;
+}
+
+const std::string& Processo::erro() const {
+    return erro_;
+}
+
+const Valor& Processo::valor(Operando operando) const {
+    switch (operando.tipo) {
+        case OPERANDO_CONSTANTE: return programa_->constantes[operando.indice];
+        case OPERANDO_LOCAL: return pilha_[base_ + operando.indice];
+        default: return pilha_[operando.indice];
+    }
+}
+
+Valor& Processo::destino(Operando operando) {
+    return operando.tipo == OPERANDO_LOCAL ? pilha_[base_ + operando.indice] : pilha_[operando.indice];
+}
+
+void Processo::escreve(const Valor& v) {
+    switch (v.index()) {
+        case 0: {
+            char buffer[24];
+            auto [fim, ec] = std::to_chars(buffer, buffer + sizeof(buffer), std::get<int64_t>(v));
+            saida_.append(buffer, fim);
+            break;
+        }
+        case 1: {
+            char buffer[32];
+            auto [fim, ec] = std::to_chars(buffer, buffer + sizeof(buffer), std::get<double>(v));
+            saida_.append(buffer, fim);
+            break;
+        }
+        case 2: saida_ += std::get<char>(v); break;
+        case 3: saida_ += std::get<bool>(v) ? "true" : "false"; break;
+        default: saida_ += std::get<std::string>(v); break;
+    }
+    saida_ += '\n';
+}
+
+// Converte a linha lida para o tipo atual da variável de destino
+bool Processo::converte(const std::string& linha, Valor& destino) {
+    const char* primeiro = linha.data();
+    const char* ultimo = linha.data() + linha.size();
+    switch (destino.index()) {
+        case 0: {
+            int64_t i;
+            auto [fim, ec] = std::from_chars(primeiro, ultimo, i);
+            if (ec != std::errc() || fim != ultimo) return false;
+            destino = i;
+            return true;
+        }
+        case 1: {
+            double f;
+            auto [fim, ec] = std::from_chars(primeiro, ultimo, f);
+            if (ec != std::errc() || fim != ultimo) return false;
+            destino = f;
+            return true;
+        }
+        case 2:
+            if (linha.size() != 1) return false;
+            destino = linha[0];
+            return true;
+        case 3:
+            if (linha != "true" && linha != "false") return false;
+            destino = linha == "true";
+            return true;
+        default:
+            destino = linha;
+            return true;
+    }
+}
+
+template <bool COM_PERFIL>
+Tarefa Processo::executar() {
+    const Programa& programa = *programa_;
+    uint32_t pc = 0;
+    uint32_t restante = orcamento_;
+
+    for (;;) {
+        if (restante-- == 0) {
+            restante = orcamento_;
+            estado_ = PROCESSO_PRONTO;
+            co_await std::suspend_always{};
+        }
+
+        if constexpr (COM_PERFIL) {
+            perfil_->instrucao(pc);
+        }
+        const Instrucao& instrucao = programa.codigo[pc++];
+        switch (instrucao.op) {
+            case OP_COPIA:
+                destino(instrucao.a) = valor(instrucao.b);
+                break;
+
+            case OP_PRINT:
+                escreve(valor(instrucao.a));
+                break;
+
+            case OP_INPUT: {
+                std::string linha;
+                while (!proxima_linha(linha)) {
+                    estado_ = PROCESSO_AGUARDANDO_ENTRADA;
+                    co_await std::suspend_always{};
+                }
+                if (!converte(linha, destino(instrucao.a))) {
+                    erro_ = "Entrada inválida para input: " + linha;
+                    co_return;
+                }
+                break;
+            }
+
+            case OP_SALTA:
+                pc = instrucao.n;
+                break;
+
+            case OP_SALTA_SE_FALSO:
+                if (!verdadeiro(valor(instrucao.a))) {
+                    pc = instrucao.n;
+                }
+                break;
+
+            case OP_CHAMA: {
+                const FuncaoCompilada& funcao = programa.funcoes[instrucao.n];
+                if (chamadas_ == quadros_.size()) {
+                    if (chamadas_ == LIMITE_CHAMADAS) {
+                        erro_ = "Estouro da pilha de chamadas";
+                        co_return;
+                    }
+                    quadros_.resize(std::min<size_t>(quadros_.size() * 2, LIMITE_CHAMADAS));
+                }
+
+                uint32_t nova_base = topo_;
+                if (pilha_.size() < nova_base + funcao.num_locais) {
+                    pilha_.resize(std::max<size_t>(nova_base + funcao.num_locais, pilha_.size() * 2));
+                }
+                // Argumentos são lidos ainda com a base de quem chama
+                for (uint32_t i = 0; i < funcao.num_parametros; i++) {
+                    pilha_[nova_base + i] = valor(programa.argumentos[instrucao.m + i]);
+                }
+
+                quadros_[chamadas_++] = {pc, base_, instrucao.a};
+                base_ = nova_base;
+                topo_ = nova_base + funcao.num_locais;
+                if constexpr (COM_PERFIL) {
+                    perfil_->chamada(pc - 1, instrucao.n);
+                }
+                pc = funcao.inicio;
+                break;
+            }
+
+            case OP_RETORNA: {
+                const Quadro& quadro = quadros_[--chamadas_];
+                if (instrucao.a.tipo != OPERANDO_NENHUM && quadro.destino.tipo != OPERANDO_NENHUM) {
+                    // O destino está no quadro de quem chamou, que não se
+                    // sobrepõe a este; um local daqui pode ser movido
+                    Valor& alvo = quadro.destino.tipo == OPERANDO_LOCAL ? pilha_[quadro.base + quadro.destino.indice]
+                                                                        : pilha_[quadro.destino.indice];
+                    if (instrucao.a.tipo == OPERANDO_LOCAL) {
+                        alvo = std::move(pilha_[base_ + instrucao.a.indice]);
+                    } else {
+                        alvo = valor(instrucao.a);
+                    }
+                }
+                topo_ = base_;
+                base_ = quadro.base;
+                pc = quadro.retorno;
+                if constexpr (COM_PERFIL) {
+                    perfil_->retorno();
+                }
+                break;
+            }
+
+            case OP_FIM:
+                co_return;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "diagnostico.hpp"
+#include "perfil.hpp"
+#include "programa.hpp"
+
+struct OpcoesCompilacao {
+    // Chamadas a funções folha pequenas viram uma cópia do corpo no lugar
+    bool expandir_folhas = true;
+    // De onde os 'import' do código são resolvidos
+    std::string diretorio = ".";
+};
+
+// Valida e compila; devolve nullptr e preenche `diagnosticos` se houver erro
+std::shared_ptr<const Programa> compilar(std::string_view codigo, std::vector<Diagnostico>& diagnosticos,
+                                         const OpcoesCompilacao& opcoes = {});
+
+enum EstadoProcesso {
+    PROCESSO_PRONTO,              // orçamento esgotado, pode continuar
+    PROCESSO_AGUARDANDO_ENTRADA,  // parado num input sem linha disponível
+    PROCESSO_TERMINADO
+};
+
+// Corrotina sem pilha própria: o estado da execução mora no Processo e o
+// quadro da corrotina guarda só o pc e o contador do orçamento.
+struct Tarefa {
+    struct promise_type {
+        std::exception_ptr excecao;
+
+        Tarefa get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { excecao = std::current_exception(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Uma execução de um Programa. continuar() só pode ser chamado por uma
+// thread por vez; fornecer_entrada() pode vir de qualquer thread.
+class Processo {
+public:
+    static constexpr uint32_t LIMITE_CHAMADAS = 10000;
+    static constexpr uint32_t QUADROS_INICIAIS = 16;
+
+    // Com `perfil`, cada instrução executada é registrada nele; o perfil
+    // precisa viver até o processo terminar
+    Processo(std::shared_ptr<const Programa> programa, uint32_t orcamento, Perfil* perfil = nullptr);
+    ~Processo();
+    Processo(const Processo&) = delete;
+    Processo& operator=(const Processo&) = delete;
+
+    // Roda até esgotar o orçamento de instruções, parar num input sem
+    // entrada ou terminar
+    EstadoProcesso continuar();
+    void fornecer_entrada(std::string linha);
+    bool tem_entrada() const;
+
+    EstadoProcesso estado() const;
+    const std::string& saida() const;
+    const std::string& erro() const; // vazio se não houve erro de execução
+
+private:
+    struct Quadro {
+        uint32_t retorno;
+        uint32_t base;
+        Operando destino;
+    };
+
+    std::shared_ptr<const Programa> programa_;
+    uint32_t orcamento_;
+    Perfil* perfil_;
+    // Escrito pela thread que roda o processo; PROCESSO_TERMINADO é publicado
+    // por último, e depois dele a thread não toca mais no Processo
+    std::atomic<EstadoProcesso> estado_{PROCESSO_PRONTO};
+
+    // Pilha contígua de valores: globais no começo, depois um bloco de
+    // num_locais por chamada ativa. Já nasce com espaço para um quadro da
+    // maior função e só cresce (dobrando) quando a recursão passa do maior
+    // tamanho já visto, então uma chamada não aloca nada.
+    std::vector<Valor> pilha_;
+    uint32_t base_ = 0;
+    uint32_t topo_ = 0;
+    // Pilha de quadros pré-alocada do mesmo jeito; `chamadas_` é o topo
+    std::vector<Quadro> quadros_;
+    uint32_t chamadas_ = 0;
+
+    mutable std::mutex trava_entradas_;
+    std::vector<std::string> entradas_;
+    size_t proxima_entrada_ = 0;
+    std::string saida_;
+    std::string erro_;
+
+    Tarefa tarefa_;
+
+    // Instanciado com e sem perfil, para o laço sem perfil não pagar nada
+    template <bool COM_PERFIL>
+    Tarefa executar();
+    const Valor& valor(Operando operando) const;
+    Valor& destino(Operando operando);
+    void escreve(const Valor& v);
+    bool proxima_linha(std::string& linha);
+    bool converte(const std::string& linha, Valor& destino);
+};
@@ -1,11 +1,55 @@
 #include "lexer.hpp"
-#include <cctype>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include "utf8.hpp"
 
-Lexer::Lexer(const std::string & texto) : texto_(texto), pos_(0) {
+namespace {
+
+enum ClasseCaractere : uint8_t {
+    CLASSE_ESPACO = 1,
+    CLASSE_DIGITO = 2,
+    CLASSE_LETRA = 4,     // letras ASCII e '_'
+    CLASSE_MULTIBYTE = 8  // byte de sequência UTF-8 (>= 0x80)
+};
+
+// Substitui isspace/isdigit/isalpha: indexada por unsigned char, não
+// depende de locale e não tem comportamento indefinido para bytes >= 0x80
+constexpr std::array<uint8_t, 256> monta_classes() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = 0; c < 256; c++) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) classes[c] |= CLASSE_ESPACO;
+        if (c >= '0' && c <= '9') classes[c] |= CLASSE_DIGITO;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') classes[c] |= CLASSE_LETRA;
+        if (c >= 0x80) classes[c] |= CLASSE_MULTIBYTE;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> CLASSES = monta_classes();
+
+inline bool eh(char c, uint8_t classe) {
+    return CLASSES[static_cast<unsigned char>(c)] & classe;
+}
+
+} // namespace
+
+Lexer::Lexer(std::string_view texto) {
+    reiniciar(texto);
+}
+
+void Lexer::reiniciar(std::string_view texto) {
+    texto_ = texto;
+    erro_utf8_ = valida_utf8(texto_); // uma passada só; daqui em diante os bytes altos são confiáveis
+    pos_ = 0;
+    linha_ = 1;
     atual_ = texto_.empty() ? '\0' : texto_[0];
 }
 
 void Lexer::avanca() {
+    if (atual_ == '\n') {
+        linha_++;
+    }
     pos_++;
     if (pos_ < texto_.size()) {
         atual_ = texto_[pos_];
@@ -14,20 +58,48 @@ void Lexer::avanca() {
     }
 }
 
+// Tamanho em bytes da letra não ASCII na posição atual, ou 0 se ali não
+// começa uma letra aceita em identificadores
+size_t Lexer::letra_multibyte() const {
+    if (!eh(atual_, CLASSE_MULTIBYTE)) {
+        return 0;
+    }
+    size_t tamanho;
+    uint32_t codigo = decodifica_utf8(texto_.data() + pos_, tamanho);
+    return letra_unicode(codigo) ? tamanho : 0;
+}
+
 void Lexer::pula_espaco() {
-    while (isspace(atual_)) {
+    while (eh(atual_, CLASSE_ESPACO)) {
         avanca();
     }
 }
 
 Token Lexer::proximo_token() {
+    if (erro_utf8_ != std::string_view::npos) {
+        Token t{ERRO, "UTF-8 inválido no byte " + std::to_string(erro_utf8_)};
+        t.linha = 1;
+        for (size_t i = 0; i < erro_utf8_; i++) {
+            t.linha += texto_[i] == '\n';
+        }
+        return t;
+    }
+
     pula_espaco();
-    if (atual_ == '/' && pos_ + 1 < texto_.size() && texto_[pos_ + 1] == '/') {
+    while (atual_ == '/' && pos_ + 1 < texto_.size() && texto_[pos_ + 1] == '/') {
         while (atual_ != '\n' && atual_ != '\0') {
             avanca();
         }
-        return proximo_token();
+        pula_espaco();
     }
+
+    int linha = linha_;
+    Token t = identifica_token();
+    t.linha = linha;
+    return t;
+}
+
+Token Lexer::identifica_token() {
     if (atual_ == '\0') {
         return {FIM_ARQUIVO, ""};
     }
@@ -36,6 +108,10 @@ Token Lexer::proximo_token() {
         avanca();
         return {DOIS_PONTOS, ":"};
     }
+    if (atual_ == ',') {
+        avanca();
+        return {VIRGULA, ","};
+    }
     if (atual_ == '=') {
         avanca();
         return {IGUAL, "="};
@@ -63,7 +139,7 @@ Token Lexer::proximo_token() {
     
     if (atual_ == '\'') {
         avanca(); // pula a aspa
-        if (atual_ != '\0' && texto_[pos_ + 1] == '\'') {
+        if (atual_ != '\0' && pos_ + 1 < texto_.size() && texto_[pos_ + 1] == '\'') {
             char c = atual_;
             avanca(); // consome o caractere
             avanca(); // consome a aspa final
@@ -77,27 +153,32 @@ Token Lexer::proximo_token() {
         return identifica_texto();
     }
 
-    if (isdigit(atual_)) {
+    if (eh(atual_, CLASSE_DIGITO)) {
         return identifica_numero();
     }
 
-    if (isalpha(atual_) || atual_ == '_') {
+    if (eh(atual_, CLASSE_LETRA) || letra_multibyte() > 0) {
         return identifica_identificador_ou_palavra_chave();
     }
 
-    std::string err(1, atual_);
-    avanca();
+    // Caractere inválido: a mensagem leva a sequência UTF-8 inteira
+    size_t tamanho = 1;
+    decodifica_utf8(texto_.data() + pos_, tamanho);
+    std::string err(texto_.substr(pos_, tamanho));
+    for (size_t i = 0; i < tamanho; i++) {
+        avanca();
+    }
     return {ERRO, err};
 }
 
 Token Lexer::identifica_texto() {
     avanca(); // pula aspas "
-    std::string valor;
+    size_t inicio = pos_;
     while (atual_ != '"' && atual_ != '\0') {
-        valor += atual_;
         avanca();
     }
     if (atual_ == '"') {
+        std::string valor(texto_.substr(inicio, pos_ - inicio));
         avanca();
         return {TEXTO, valor};
     }
@@ -105,30 +186,65 @@ Token Lexer::identifica_texto() {
 }
 
 Token Lexer::identifica_numero() {
-    std::string valor;
-    bool tem_ponto = false;
+    size_t inicio = pos_;
+    int pontos = 0;
 
-    while (isdigit(atual_) || (atual_ == '.' && !tem_ponto)) {
+    while (eh(atual_, CLASSE_DIGITO) || atual_ == '.') {
         if (atual_ == '.') {
-            tem_ponto = true;
+            pontos++;
         }
-        valor += atual_;
         avanca();
     }
 
-    if (tem_ponto) {
-        return {NUMERO, valor};  // Ainda usamos NUMERO, sem novo token FLOAT_LITERAL
+    std::string valor(texto_.substr(inicio, pos_ - inicio));
+    const char* primeiro = texto_.data() + inicio;
+    const char* ultimo = texto_.data() + pos_;
+
+    // Exige dígitos dos dois lados do ponto: rejeita "1.2.3" e "1."
+    if (pontos > 1 || valor.back() == '.') {
+        return {ERRO, "Número mal formatado: " + valor};
+    }
+
+    // O literal é decodificado uma única vez aqui; o parser só consulta o tipo
+    if (pontos == 1) {
+        Token t{NUMERO_REAL, valor};
+        auto [fim, ec] = std::from_chars(primeiro, ultimo, t.real);
+        if (ec == std::errc::result_out_of_range && fim == ultimo && valor.find_first_not_of('0') == valor.find('.')) {
+            // Sem expoente, só um literal como 0.000...01 fica pequeno demais
+            // para um double; ele vale 0. Fora do intervalo é só o estouro.
+            t.real = 0.0;
+            return t;
+        }
+        if (ec != std::errc() || fim != ultimo) {
+            return {ERRO, "Número real fora do intervalo: " + valor};
+        }
+        return t;
     }
 
-    return {NUMERO, valor};
+    Token t{NUMERO_INTEIRO, valor};
+    auto [fim, ec] = std::from_chars(primeiro, ultimo, t.inteiro);
+    if (ec != std::errc() || fim != ultimo) {
+        return {ERRO, "Número inteiro fora do intervalo: " + valor};
+    }
+    return t;
 }
 
 Token Lexer::identifica_identificador_ou_palavra_chave() {
-    std::string valor;
-    while (isalnum(atual_) || atual_ == '_') {
-        valor += atual_;
-        avanca();
+    size_t inicio = pos_;
+    for (;;) {
+        if (eh(atual_, CLASSE_LETRA | CLASSE_DIGITO)) {
+            avanca();
+            continue;
+        }
+        size_t tamanho = letra_multibyte();
+        if (tamanho == 0) {
+            break;
+        }
+        for (size_t i = 0; i < tamanho; i++) {
+            avanca();
+        }
     }
+    std::string valor(texto_.substr(inicio, pos_ - inicio));
 
     if (valor == "var") return {VAR, valor};
     if (valor == "print") return {PRINT, valor};
@@ -138,6 +254,8 @@ Token Lexer::identifica_identificador_ou_palavra_chave() {
     if (valor == "while") return {WHILE, valor};
     if (valor == "for") return {FOR, valor};
     if (valor == "func") return {FUNC, valor};
+    if (valor == "return") return {RETURN, valor};
+    if (valor == "import") return {IMPORT, valor};
     if (valor == "int") return {INT, valor};
     if (valor == "float") return {FLOAT, valor};
     if (valor == "char") return {CHAR, valor};
@@ -1,18 +1,24 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include "token.hpp"
 
 class Lexer {
 public:
-    Lexer(const std::string & texto);
+    // Não copia o texto: ele precisa continuar vivo enquanto o Lexer for usado
+    explicit Lexer(std::string_view texto = {});
+    void reiniciar(std::string_view texto);
     Token proximo_token();
 
 private:
-    std::string texto_;
+    std::string_view texto_;
+    size_t erro_utf8_; // primeiro byte UTF-8 inválido, ou npos
     size_t pos_;
+    int linha_;
     char atual_;
 
     void avanca();
+    size_t letra_multibyte() const;
     void pula_espaco();
     Token identifica_token();
     Token identifica_identificador_ou_palavra_chave();
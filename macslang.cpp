@@ -0,0 +1,182 @@
+#include "macslang.hpp"
+#include "macslang.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <thread>
+#include "lexer.hpp"
+#include "parser.hpp"
+
+namespace macslang {
+
+struct Validador::Impl {
+    Lexer lexer;
+    Parser parser;
+    std::vector<Token> tokens;
+};
+
+Validador::Validador() : impl_(std::make_unique<Impl>()) {
+    impl_->parser.usarSaida(false);
+}
+
+Validador::~Validador() = default;
+Validador::Validador(Validador&&) noexcept = default;
+Validador& Validador::operator=(Validador&&) noexcept = default;
+
+Resultado Validador::validar(std::span<const char> codigo) {
+    Resultado resultado;
+    Lexer& lexer = impl_->lexer;
+    Parser& parser = impl_->parser;
+    std::vector<Token>& tokens = impl_->tokens;
+    lexer.reiniciar(std::string_view(codigo.data(), codigo.size()));
+    tokens.clear();
+
+    {
+        EscopoFase fase(FASE_LEXER);
+        do {
+            tokens.push_back(lexer.proximo_token());
+        } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+    }
+
+    if (tokens.back().tipo == ERRO) {
+        resultado.diagnosticos.push_back({DIAGNOSTICO_LEXICO, tokens.back().linha, tokens.back().valor});
+        return resultado;
+    }
+
+    EscopoFase fase(FASE_PARSER);
+    parser.reiniciar(tokens);
+    resultado.valido = parser.parse();
+    resultado.diagnosticos = parser.diagnosticos();
+    return resultado;
+}
+
+Resultado validar(std::span<const char> codigo) {
+    thread_local Validador validador;
+    return validador.validar(codigo);
+}
+
+namespace {
+
+// Validadores livres entre chamadas de validar_lote. As threads do lote são
+// novas a cada chamada, então um thread_local delas morreria junto; daqui
+// cada uma pega um Validador já aquecido e o devolve ao terminar.
+class ReservaValidadores {
+public:
+    std::unique_ptr<Validador> pegar() {
+        std::lock_guard<std::mutex> trava(mutex_);
+        if (livres_.empty()) {
+            return std::make_unique<Validador>();
+        }
+        std::unique_ptr<Validador> validador = std::move(livres_.back());
+        livres_.pop_back();
+        return validador;
+    }
+
+    void devolver(std::unique_ptr<Validador> validador) {
+        std::lock_guard<std::mutex> trava(mutex_);
+        livres_.push_back(std::move(validador));
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Validador>> livres_;
+};
+
+ReservaValidadores& reserva() {
+    static ReservaValidadores reserva;
+    return reserva;
+}
+
+} // namespace
+
+std::vector<Resultado> validar_lote(std::span<const std::span<const char>> codigos, unsigned threads) {
+    std::vector<Resultado> resultados(codigos.size());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, codigos.size()));
+
+    // Cada thread pega o próximo índice livre, então códigos de tamanhos
+    // muito diferentes não deixam uma thread ociosa enquanto outra trabalha
+    std::atomic<size_t> proximo{0};
+    auto trabalha = [&] {
+        std::unique_ptr<Validador> validador = reserva().pegar();
+        for (size_t i = proximo++; i < codigos.size(); i = proximo++) {
+            resultados[i] = validador->validar(codigos[i]);
+        }
+        reserva().devolver(std::move(validador));
+    };
+
+    if (threads <= 1) {
+        trabalha();
+        return resultados;
+    }
+
+    std::vector<std::thread> trabalhadores;
+    for (unsigned t = 0; t < threads; t++) {
+        trabalhadores.emplace_back(trabalha);
+    }
+    for (std::thread& t : trabalhadores) {
+        t.join();
+    }
+    return resultados;
+}
+
+} // namespace macslang
+
+struct macslang_validador {
+    macslang::Validador validador;
+    macslang::Resultado ultimo;
+};
+
+extern "C" {
+
+macslang_validador* macslang_validador_criar(void) {
+    return new (std::nothrow) macslang_validador();
+}
+
+void macslang_validador_destruir(macslang_validador* validador) {
+    delete validador;
+}
+
+int macslang_validar(macslang_validador* validador, const char* codigo, size_t tamanho) {
+    // Exceções não podem atravessar a fronteira C
+    try {
+        validador->ultimo = validador->validador.validar({codigo, tamanho});
+    } catch (...) {
+        validador->ultimo = {};
+        return -1;
+    }
+    return validador->ultimo.valido ? 1 : 0;
+}
+
+size_t macslang_num_diagnosticos(const macslang_validador* validador) {
+    return validador->ultimo.diagnosticos.size();
+}
+
+macslang_diagnostico macslang_diagnostico_em(const macslang_validador* validador, size_t indice) {
+    const Diagnostico& d = validador->ultimo.diagnosticos[indice];
+    return {d.tipo == DIAGNOSTICO_LEXICO ? 1 : 0, d.linha, d.mensagem.c_str()};
+}
+
+void macslang_validar_lote(const char* const* codigos, const size_t* tamanhos, size_t quantidade,
+                           int* validos, unsigned threads) {
+    try {
+        std::vector<std::span<const char>> entradas;
+        entradas.reserve(quantidade);
+        for (size_t i = 0; i < quantidade; i++) {
+            entradas.push_back({codigos[i], tamanhos[i]});
+        }
+
+        std::vector<macslang::Resultado> resultados = macslang::validar_lote(entradas, threads);
+        for (size_t i = 0; i < quantidade; i++) {
+            validos[i] = resultados[i].valido ? 1 : 0;
+        }
+    } catch (...) {
+        std::fill(validos, validos + quantidade, -1);
+    }
+}
+
+} // extern "C"
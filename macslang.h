@@ -0,0 +1,39 @@
+#ifndef MACSLANG_H
+#define MACSLANG_H
+
+/* Interface C da validação de MacsLang (implementada em macslang.cpp) */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct macslang_validador macslang_validador;
+
+typedef struct {
+    int lexico; /* 1 para erro léxico, 0 para erro de sintaxe */
+    int linha;
+    const char* mensagem;
+} macslang_diagnostico;
+
+macslang_validador* macslang_validador_criar(void);
+void macslang_validador_destruir(macslang_validador* validador);
+
+/* Devolve 1 se o código é válido, 0 se não é e -1 em falha interna (falta
+   de memória). Os diagnósticos ficam disponíveis até a próxima chamada com
+   o mesmo validador; `indice` deve ser menor que macslang_num_diagnosticos. */
+int macslang_validar(macslang_validador* validador, const char* codigo, size_t tamanho);
+size_t macslang_num_diagnosticos(const macslang_validador* validador);
+macslang_diagnostico macslang_diagnostico_em(const macslang_validador* validador, size_t indice);
+
+/* Valida `quantidade` códigos e grava 1/0 (ou -1) em `validos[i]`.
+   threads == 0 usa todos os núcleos. */
+void macslang_validar_lote(const char* const* codigos, const size_t* tamanhos, size_t quantidade,
+                           int* validos, unsigned threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
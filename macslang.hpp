@@ -0,0 +1,40 @@
+#pragma once
+#include <memory>
+#include <span>
+#include <vector>
+#include "diagnostico.hpp"
+
+// API para embutir a validação de MacsLang em outro programa, sem processo
+// novo nem saída no terminal. Os erros voltam como diagnósticos.
+namespace macslang {
+
+struct Resultado {
+    bool valido = false;
+    std::vector<Diagnostico> diagnosticos;
+};
+
+// Guarda Lexer, Parser e vetor de tokens entre chamadas, então validar
+// muitos programas pequenos não recria buffers nem mapas de escopo.
+// Uma instância não pode ser usada por duas threads ao mesmo tempo.
+class Validador {
+public:
+    Validador();
+    ~Validador();
+    Validador(Validador&&) noexcept;
+    Validador& operator=(Validador&&) noexcept;
+
+    Resultado validar(std::span<const char> codigo);
+
+private:
+    struct Impl; // Lexer, Parser e tokens ficam em macslang.cpp
+    std::unique_ptr<Impl> impl_;
+};
+
+// Usa um Validador por thread
+Resultado validar(std::span<const char> codigo);
+
+// Valida cada código de `codigos`, devolvendo os resultados na mesma ordem.
+// threads == 0 usa std::thread::hardware_concurrency().
+std::vector<Resultado> validar_lote(std::span<const std::span<const char>> codigos, unsigned threads = 0);
+
+} // namespace macslang
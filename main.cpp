@@ -1,8 +1,19 @@
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "alocacoes.hpp"
+#include "canal_tokens.hpp"
+#include "escalonador.hpp"
+#include "interpretador.hpp"
 #include "lexer.hpp"
+#include "modulos.hpp"
 #include "parser.hpp"
+#include "perfil.hpp"
 
 std::string nome_token(TokenTipo tipo) {
     switch (tipo) {
@@ -14,6 +25,8 @@ std::string nome_token(TokenTipo tipo) {
         case WHILE: return "WHILE";
         case FOR: return "FOR";
         case FUNC: return "FUNC";
+        case RETURN: return "RETURN";
+        case IMPORT: return "IMPORT";
         case INT: return "INT";
         case FLOAT: return "FLOAT";
         case CHAR: return "CHAR";
@@ -21,9 +34,11 @@ std::string nome_token(TokenTipo tipo) {
         case STRING: return "STRING";
         case VOID: return "VOID";
         case IDENTIFICADOR: return "IDENTIFICADOR";
-        case NUMERO: return "NUMERO";
+        case NUMERO_INTEIRO: return "NUMERO_INTEIRO";
+        case NUMERO_REAL: return "NUMERO_REAL";
         case TEXTO: return "TEXTO";
         case DOIS_PONTOS: return "DOIS_PONTOS";
+        case VIRGULA: return "VIRGULA";
         case IGUAL: return "IGUAL";
         case PONTO_E_VIRGULA: return "PONTO_E_VIRGULA";
         case ABRE_PARENTESE: return "ABRE_PARENTESE";
@@ -36,7 +51,237 @@ std::string nome_token(TokenTipo tipo) {
     }
 }
 
-int main() {    
+enum Resultado { CORRETO, ERRO_SINTATICO, ERRO_LEXICO };
+
+// Debug: mostra os tokens
+void lista_token(std::ostream& saida, const Token& token) {
+    saida << "Token { " << "\033[1;36m" << nome_token(token.tipo) << "\033[0m, " << "\033[1;33m\"" << token.valor << "\"\033[0m" << " }\n";
+}
+
+// Lexer inteiro primeiro, depois o parser sobre o vetor de tokens
+Resultado compila_sequencial(const std::string& codigo, CarregadorModulos& modulos, size_t& num_tokens) {
+    std::cout << "\033[1;34m==== LEXER ====\033[0m\n";
+    Lexer lexer(codigo);
+    std::vector<Token> tokens;
+    Token token;
+
+    {
+        EscopoFase fase(FASE_LEXER);
+        do {
+            token = lexer.proximo_token();
+            lista_token(std::cout, token);
+            tokens.push_back(std::move(token));
+        } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+    }
+
+    num_tokens = tokens.size();
+    if (tokens.back().tipo == ERRO) {
+        std::cerr << "Erro léxico encontrado: " << tokens.back().valor << "\n";
+        return ERRO_LEXICO;
+    }
+
+    std::cout << "\n\033[1;32m==== PARSER ====\033[0m\n";
+    EscopoFase fase(FASE_PARSER);
+    Parser parser(std::move(tokens));
+    parser.usarModulos(&modulos, ".");
+    return parser.parse() ? CORRETO : ERRO_SINTATICO;
+}
+
+// Guarda o que o parser escreve em stdout e stderr num registro só, na ordem
+// em que foi escrito, para reproduzir depois intercalado como no modo
+// sequencial (que com 2>&1 mostra erros e avisos na ordem original)
+class RegistroSaida {
+public:
+    RegistroSaida() : buffer_saida_(*this, false), buffer_erros_(*this, true),
+                      saida_(&buffer_saida_), erros_(&buffer_erros_) {}
+    RegistroSaida(const RegistroSaida&) = delete;
+    RegistroSaida& operator=(const RegistroSaida&) = delete;
+
+    std::ostream& saida() { return saida_; }
+    std::ostream& erros() { return erros_; }
+
+    void reproduzir(std::ostream& saida, std::ostream& erros) const {
+        for (const auto& [erro, texto] : trechos_) {
+            (erro ? erros : saida) << texto;
+        }
+    }
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        Buffer(RegistroSaida& registro, bool erro) : registro_(registro), erro_(erro) {}
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                char caractere = traits_type::to_char_type(c);
+                registro_.acrescenta(erro_, &caractere, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char* dados, std::streamsize n) override {
+            registro_.acrescenta(erro_, dados, static_cast<size_t>(n));
+            return n;
+        }
+
+    private:
+        RegistroSaida& registro_;
+        bool erro_;
+    };
+
+    // Escritas seguidas no mesmo stream viram um trecho só
+    void acrescenta(bool erro, const char* dados, size_t n) {
+        if (trechos_.empty() || trechos_.back().first != erro) {
+            trechos_.emplace_back(erro, std::string());
+        }
+        trechos_.back().second.append(dados, n);
+    }
+
+    std::vector<std::pair<bool, std::string>> trechos_; // stderr?, texto
+    Buffer buffer_saida_;
+    Buffer buffer_erros_;
+    std::ostream saida_;
+    std::ostream erros_;
+};
+
+// Lexer numa thread produtora e parser nesta thread, ligados por um
+// CanalTokens. A saída de cada fase é guardada e impressa na mesma ordem do
+// modo sequencial; em caso de erro léxico a saída do parser é descartada,
+// assim como os resumos de módulos que ele importou (o modo sequencial nem
+// chegaria a rodar o parser).
+Resultado compila_pipeline(const std::string& codigo, CarregadorModulos& modulos, size_t& num_tokens) {
+    CanalTokens canal;
+    std::ostringstream listagem;
+    Token ultimo;
+
+    std::thread produtor([&] {
+        EscopoFase fase(FASE_LEXER);
+        Lexer lexer(codigo);
+        Token token;
+        bool continua = true;
+        while (continua) {
+            token = lexer.proximo_token();
+            lista_token(listagem, token);
+            num_tokens++;
+            if (token.tipo == FIM_ARQUIVO || token.tipo == ERRO) {
+                ultimo = token;
+                continua = false;
+            }
+            if (!canal.enviar(std::move(token))) {
+                continua = false;
+            }
+        }
+        canal.fechar();
+    });
+
+    RegistroSaida saida_parser;
+    bool correto;
+    modulos.adiar_resumos(true);
+    {
+        EscopoFase fase(FASE_PARSER);
+        Parser parser(canal);
+        parser.usarSaida(saida_parser.saida(), saida_parser.erros());
+        parser.usarModulos(&modulos, ".");
+        correto = parser.parse();
+    }
+    canal.cancelar();
+    produtor.join();
+
+    std::cout << "\033[1;34m==== LEXER ====\033[0m\n" << listagem.str();
+    if (ultimo.tipo == ERRO) {
+        modulos.descartar_resumos();
+        std::cerr << "Erro léxico encontrado: " << ultimo.valor << "\n";
+        return ERRO_LEXICO;
+    }
+    modulos.gravar_resumos();
+
+    std::cout << "\n\033[1;32m==== PARSER ====\033[0m\n";
+    saida_parser.reproduzir(std::cout, std::cerr);
+    return correto ? CORRETO : ERRO_SINTATICO;
+}
+
+// Roda o programa num Escalonador de uma thread, lendo do stdin cada linha
+// pedida por input. Com perfil, grava perfil.folded e mostra o relatório
+// dos blocos executados ao final; nesse caso as funções folha não são
+// expandidas, senão as linhas delas seriam contadas na linha da chamada.
+bool executa(const std::string& codigo, bool com_perfil, std::chrono::microseconds amostragem) {
+    std::vector<Diagnostico> diagnosticos;
+    OpcoesCompilacao opcoes;
+    opcoes.expandir_folhas = !com_perfil;
+    std::shared_ptr<const Programa> programa = compilar(codigo, diagnosticos, opcoes);
+    if (!programa) {
+        for (const Diagnostico& d : diagnosticos) {
+            std::cerr << "Linha " << d.linha << ": " << d.mensagem << "\n";
+        }
+        return false;
+    }
+
+    std::cout << "\n\033[1;33m==== EXECUÇÃO ====\033[0m\n";
+    std::unique_ptr<Perfil> perfil;
+    if (com_perfil) {
+        perfil = std::make_unique<Perfil>(programa, amostragem);
+    }
+    Escalonador escalonador(1);
+    Processo& processo = escalonador.criar(programa, 1000, perfil.get());
+    size_t impresso = 0;
+    for (;;) {
+        escalonador.aguardar();
+        std::cout << processo.saida().substr(impresso) << std::flush;
+        impresso = processo.saida().size();
+        if (processo.estado() == PROCESSO_TERMINADO) {
+            break;
+        }
+
+        std::string linha;
+        if (!std::getline(std::cin, linha)) {
+            std::cerr << "Entrada terminou antes do fim do programa\n";
+            return false;
+        }
+        escalonador.fornecer_entrada(processo, linha);
+    }
+
+    if (perfil) {
+        std::ofstream folded("perfil.folded");
+        perfil->escrever_folded(folded);
+        std::cout << "\n\033[1;35m==== PERFIL ====\033[0m\n";
+        perfil->escrever_relatorio(std::cout);
+        std::cout << "Pilhas gravadas em perfil.folded\n";
+    }
+
+    if (!processo.erro().empty()) {
+        std::cerr << "Erro de execução: " << processo.erro() << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // --pipeline: roda lexer e parser em threads separadas
+    // --executar: depois de validar, executa o programa
+    // --perfil: executa com perfil; grava perfil.folded e mostra o relatório
+    // --amostragem <µs>: no perfil, amostra também a pilha a cada intervalo
+    bool com_perfil = false;
+    bool pipeline = false;
+    bool executar = false;
+    std::chrono::microseconds amostragem{0};
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--perfil") {
+            com_perfil = true;
+            executar = true;
+        } else if (std::string(argv[i]) == "--amostragem" && i + 1 < argc) {
+            amostragem = std::chrono::microseconds(std::atoi(argv[++i]));
+            com_perfil = true;
+            executar = true;
+        } else if (std::string(argv[i]) == "--pipeline") {
+            pipeline = true;
+        } else if (std::string(argv[i]) == "--executar") {
+            executar = true;
+        } else {
+            std::cerr << "Opção desconhecida: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
     std::ifstream arquivo("entrada.macslang");
     if (!arquivo) {
         std::cerr << "Não foi possível abrir o arquivo entrada.macslang\n";
@@ -47,32 +292,28 @@ int main() {
     buffer << arquivo.rdbuf();
     std::string codigo = buffer.str();
 
-    std::cout << "\033[1;34m==== LEXER ====\033[0m\n";
-    Lexer lexer(codigo);
-    std::vector<Token> tokens;
-    Token token;
-
-    do {
-        token = lexer.proximo_token();
-        tokens.push_back(token);
+    zerar_alocacoes();
 
-        // Debug: mostra os tokens
-       std::cout << "Token { " << "\033[1;36m" << nome_token(token.tipo) << "\033[0m, " << "\033[1;33m\"" << token.valor << "\"\033[0m" << " }\n";
-    } while (token.tipo != FIM_ARQUIVO && token.tipo != ERRO);
+    CarregadorModulos modulos;
+    size_t num_tokens = 0;
+    Resultado resultado = pipeline ? compila_pipeline(codigo, modulos, num_tokens)
+                                   : compila_sequencial(codigo, modulos, num_tokens);
 
-    if (token.tipo == ERRO) {
-        std::cerr << "Erro léxico encontrado: " << token.valor << "\n";
+    if (resultado == ERRO_LEXICO) {
+        relatorio_alocacoes(std::cerr, num_tokens);
         return 1;
     }
 
-    std::cout << "\n\033[1;32m==== PARSER ====\033[0m\n";
-    Parser parser(tokens);
-    if (parser.parse()) {
+    if (resultado == CORRETO) {
         std::cout << "Código sintaticamente correto.\n";
     } else {
         std::cerr << "Erro de sintaxe detectado.\n";
-        return 1;
     }
 
-    return 0;
+    relatorio_alocacoes(std::cerr, num_tokens);
+
+    if (executar && resultado == CORRETO && !executa(codigo, com_perfil, amostragem)) {
+        return 1;
+    }
+    return resultado == CORRETO ? 0 : 1;
 }
@@ -0,0 +1,293 @@
+#include "modulos.hpp"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "lexer.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* CABECALHO_RESUMO = "macslang-resumo 2";
+
+bool le_arquivo(const std::string& caminho, std::string& conteudo) {
+    std::ifstream arquivo(caminho, std::ios::binary);
+    if (!arquivo) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << arquivo.rdbuf();
+    conteudo = buffer.str();
+    return true;
+}
+
+std::string hex(uint64_t valor) {
+    std::ostringstream saida;
+    saida << std::hex << valor;
+    return saida.str();
+}
+
+std::string caminho_resumo(const std::string& modulo, uint64_t hash) {
+    fs::path caminho(modulo);
+    return (caminho.parent_path() / ".macslang_cache" / (caminho.filename().string() + "-" + hex(hash) + ".resumo")).string();
+}
+
+// Nome do temporário de um resumo: único entre threads e processos que
+// gravam o mesmo resumo ao mesmo tempo
+std::string nome_temporario(const std::string& arquivo) {
+    static const uint64_t processo = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    static std::atomic<uint64_t> contador{0};
+    return arquivo + "." + hex(processo) + "-" + hex(contador.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+}
+
+// Formato, uma entrada por linha:
+//   dep <hash> <caminho>
+//   var <nome> <tipo>
+//   func <nome> <retorno> [<tipo do parâmetro>...]
+//   fim <número de entradas acima>
+void grava_resumo(const std::string& arquivo, const InterfaceModulo& interface,
+                  const std::vector<DependenciaModulo>& dependencias) {
+    std::error_code ec;
+    fs::create_directories(fs::path(arquivo).parent_path(), ec);
+
+    // Grava num temporário e renomeia, para outro compilador nunca ler um resumo pela metade
+    std::string temporario = nome_temporario(arquivo);
+    {
+        std::ofstream saida(temporario);
+        if (!saida) {
+            return; // sem cache, mas a compilação continua valendo
+        }
+        saida << CABECALHO_RESUMO << "\n";
+        for (const DependenciaModulo& d : dependencias) {
+            saida << "dep " << hex(d.hash) << " " << d.caminho << "\n";
+        }
+        for (const auto& [nome, simbolo] : interface.variaveis) {
+            saida << "var " << nome << " " << simbolo.tipo << "\n";
+        }
+        for (const auto& [nome, funcao] : interface.funcoes) {
+            saida << "func " << nome << " " << funcao.retorno;
+            for (const std::string& tipo : funcao.parametros) {
+                saida << " " << tipo;
+            }
+            saida << "\n";
+        }
+        saida << "fim " << dependencias.size() + interface.variaveis.size() + interface.funcoes.size() << "\n";
+        if (!saida.flush()) {
+            saida.close();
+            fs::remove(temporario, ec);
+            return;
+        }
+    }
+    fs::rename(temporario, arquivo, ec);
+    if (ec) {
+        fs::remove(temporario, ec);
+    }
+}
+
+// Falha (e força recompilação) se o resumo não existe, está corrompido ou
+// truncado (sem a linha "fim" com a contagem certa) ou se algum módulo
+// importado mudou desde que foi gravado
+bool le_resumo(const std::string& arquivo, InterfaceModulo& interface, std::vector<DependenciaModulo>& dependencias) {
+    std::ifstream entrada(arquivo);
+    std::string linha;
+    if (!entrada || !std::getline(entrada, linha) || linha != CABECALHO_RESUMO) {
+        return false;
+    }
+
+    size_t entradas = 0;
+    while (std::getline(entrada, linha)) {
+        std::istringstream campos(linha);
+        std::string tipo;
+        campos >> tipo;
+        if (tipo == "fim") {
+            size_t contagem;
+            std::string resto;
+            return campos >> contagem && !(campos >> resto) && contagem == entradas && !std::getline(entrada, linha);
+        }
+
+        entradas++;
+        if (tipo == "dep") {
+            DependenciaModulo d;
+            campos >> std::hex >> d.hash;
+            campos.ignore(1);
+            std::getline(campos, d.caminho);
+            std::string conteudo;
+            if (!campos || !le_arquivo(d.caminho, conteudo) || hash_conteudo(conteudo) != d.hash) {
+                return false;
+            }
+            dependencias.push_back(std::move(d));
+        } else if (tipo == "var") {
+            std::string nome, tipo_variavel;
+            if (!(campos >> nome >> tipo_variavel)) {
+                return false;
+            }
+            interface.variaveis.push_back({nome, {tipo_variavel, {}}});
+        } else if (tipo == "func") {
+            std::string nome;
+            Funcao funcao;
+            if (!(campos >> nome >> funcao.retorno)) {
+                return false;
+            }
+            for (std::string parametro; campos >> parametro;) {
+                funcao.parametros.push_back(parametro);
+            }
+            funcao.tem_retorno = true;
+            interface.funcoes.emplace_back(nome, std::move(funcao));
+        } else {
+            return false;
+        }
+    }
+    return false; // sem "fim": resumo truncado
+}
+
+} // namespace
+
+uint64_t hash_conteudo(std::string_view texto) {
+    // FNV-1a de 64 bits
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : texto) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string CarregadorModulos::caminho_canonico(const std::string& caminho, const std::string& diretorio) {
+    std::error_code ec;
+    std::string modulo = fs::weakly_canonical(fs::path(diretorio) / caminho, ec).string();
+    if (ec) {
+        modulo = (fs::path(diretorio) / caminho).lexically_normal().string();
+    }
+    return modulo;
+}
+
+bool CarregadorModulos::carregar(const std::string& caminho, const std::string& diretorio, Programa* programa,
+                                 InterfaceModulo& interface, std::vector<DependenciaModulo>& dependencias,
+                                 std::string& erro) {
+    std::error_code ec;
+    std::string modulo = caminho_canonico(caminho, diretorio);
+
+    if (programa != programa_) {
+        programa_ = programa;
+        gerados_.clear();
+    }
+    if (programa) {
+        auto gerado = gerados_.find(modulo);
+        if (gerado != gerados_.end()) {
+            interface = gerado->second.interface;
+            dependencias.insert(dependencias.end(), gerado->second.dependencias.begin(),
+                                gerado->second.dependencias.end());
+            return true;
+        }
+    }
+
+    auto ciclo = std::find(em_compilacao_.begin(), em_compilacao_.end(), modulo);
+    if (ciclo != em_compilacao_.end()) {
+        erro = "Ciclo de imports: ";
+        for (auto it = ciclo; it != em_compilacao_.end(); ++it) {
+            erro += *it + " -> ";
+        }
+        erro += modulo;
+        return false;
+    }
+
+    std::string codigo;
+    if (!le_arquivo(modulo, codigo)) {
+        erro = "Não foi possível abrir o módulo '" + caminho + "'";
+        return false;
+    }
+    uint64_t hash = hash_conteudo(codigo);
+
+    std::vector<DependenciaModulo> dependencias_modulo;
+    std::string resumo = caminho_resumo(modulo, hash);
+    if (!programa && usar_cache_ && le_resumo(resumo, interface, dependencias_modulo)) {
+        resumos_usados_++;
+    } else {
+        interface = {};
+        dependencias_modulo.clear();
+        if (!compilar(modulo, codigo, programa, interface, dependencias_modulo, erro)) {
+            return false;
+        }
+        if (usar_cache_ && (!programa || !fs::exists(resumo, ec))) {
+            if (adiar_resumos_) {
+                pendentes_.push_back({resumo, interface, dependencias_modulo});
+            } else {
+                grava_resumo(resumo, interface, dependencias_modulo);
+            }
+        }
+    }
+
+    dependencias_modulo.insert(dependencias_modulo.begin(), DependenciaModulo{modulo, hash});
+    dependencias.insert(dependencias.end(), dependencias_modulo.begin(), dependencias_modulo.end());
+    if (programa) {
+        gerados_[modulo] = {interface, std::move(dependencias_modulo)};
+    }
+    return true;
+}
+
+bool CarregadorModulos::compilar(const std::string& caminho, const std::string& codigo, Programa* programa,
+                                 InterfaceModulo& interface, std::vector<DependenciaModulo>& dependencias,
+                                 std::string& erro) {
+    Lexer lexer(codigo);
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(lexer.proximo_token());
+    } while (tokens.back().tipo != FIM_ARQUIVO && tokens.back().tipo != ERRO);
+
+    if (tokens.back().tipo == ERRO) {
+        erro = caminho + ":" + std::to_string(tokens.back().linha) + ": " + tokens.back().valor;
+        return false;
+    }
+
+    em_compilacao_.push_back(caminho);
+    Parser parser(std::move(tokens));
+    parser.usarSaida(false);
+    parser.usarModulos(this, fs::path(caminho).parent_path().string());
+    parser.usarPrograma(programa);
+    bool correto = parser.parse();
+    em_compilacao_.pop_back();
+
+    if (!correto) {
+        erro = caminho + ": erro de sintaxe";
+        if (!parser.diagnosticos().empty()) {
+            const Diagnostico& primeiro = parser.diagnosticos().front();
+            erro = caminho + ":" + std::to_string(primeiro.linha) + ": " + primeiro.mensagem;
+        }
+        return false;
+    }
+
+    modulos_compilados_++;
+    interface = parser.interface();
+    dependencias = parser.dependencias();
+    return true;
+}
+
+void CarregadorModulos::adiar_resumos(bool adiar) {
+    adiar_resumos_ = adiar;
+}
+
+void CarregadorModulos::gravar_resumos() {
+    for (const ResumoPendente& pendente : pendentes_) {
+        grava_resumo(pendente.arquivo, pendente.interface, pendente.dependencias);
+    }
+    pendentes_.clear();
+}
+
+void CarregadorModulos::descartar_resumos() {
+    pendentes_.clear();
+}
+
+void CarregadorModulos::usar_cache(bool usar) {
+    usar_cache_ = usar;
+}
+
+size_t CarregadorModulos::resumos_usados() const {
+    return resumos_usados_;
+}
+
+size_t CarregadorModulos::modulos_compilados() const {
+    return modulos_compilados_;
+}
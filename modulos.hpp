@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "parser.hpp"
+
+// Resolve os 'import' de um programa. Na primeira vez que um módulo é
+// compilado, grava um resumo da interface dele em
+// <diretório do módulo>/.macslang_cache/<nome>-<hash>.resumo, onde o hash é
+// o do conteúdo do arquivo. Nas próximas vezes o resumo é lido no lugar de
+// passar o módulo pelo Lexer e pelo Parser de novo.
+//
+// O resumo também guarda o hash de cada módulo que ele importou; se algum
+// mudou, o módulo é compilado de novo para revalidar o uso que faz deles.
+//
+// Para execução o resumo não basta: com um Programa, o módulo é sempre
+// compilado e o código dele gerado no Programa, uma vez só por Programa
+// mesmo que vários arquivos o importem.
+class CarregadorModulos {
+public:
+    // `caminho` é relativo a `diretorio` (o do arquivo que importa). Acrescenta
+    // o módulo e tudo o que ele importa a `dependencias`. `programa` pode ser
+    // nullptr quando só se quer validar.
+    bool carregar(const std::string& caminho, const std::string& diretorio, Programa* programa,
+                  InterfaceModulo& interface, std::vector<DependenciaModulo>& dependencias, std::string& erro);
+
+    // Caminho absoluto e normalizado que identifica o módulo
+    static std::string caminho_canonico(const std::string& caminho, const std::string& diretorio);
+
+    size_t resumos_usados() const;
+    size_t modulos_compilados() const;
+
+    // Com `adiar`, os resumos novos ficam pendentes até gravar_resumos() ou
+    // descartar_resumos(); serve para quem só sabe depois se a compilação
+    // toda valeu (o modo pipeline, que pode achar um erro léxico no fim)
+    void adiar_resumos(bool adiar);
+    void gravar_resumos();
+    void descartar_resumos();
+
+    // Sem cache, todo módulo é compilado e nenhum resumo é lido ou gravado
+    void usar_cache(bool usar);
+
+private:
+    struct ModuloGerado {
+        InterfaceModulo interface;
+        std::vector<DependenciaModulo> dependencias; // o próprio módulo e os que ele importa
+    };
+
+    struct ResumoPendente {
+        std::string arquivo;
+        InterfaceModulo interface;
+        std::vector<DependenciaModulo> dependencias;
+    };
+
+    std::vector<std::string> em_compilacao_; // pilha de imports, para achar ciclos
+    size_t resumos_usados_ = 0;
+    size_t modulos_compilados_ = 0;
+    Programa* programa_ = nullptr; // onde estão os módulos de gerados_
+    std::unordered_map<std::string, ModuloGerado> gerados_;
+    bool adiar_resumos_ = false;
+    bool usar_cache_ = true;
+    std::vector<ResumoPendente> pendentes_;
+
+    bool compilar(const std::string& caminho, const std::string& codigo, Programa* programa,
+                  InterfaceModulo& interface, std::vector<DependenciaModulo>& dependencias, std::string& erro);
+};
+
+uint64_t hash_conteudo(std::string_view texto);
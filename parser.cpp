@@ -1,20 +1,130 @@
 #include "parser.hpp"
-#include <iostream>
+#include <array>
+#include "modulos.hpp"
+
+namespace {
+
+Valor valor_padrao(const std::string& tipo) {
+    if (tipo == "float") return 0.0;
+    if (tipo == "char") return '\0';
+    if (tipo == "bool") return false;
+    if (tipo == "string") return std::string();
+    return int64_t{0};
+}
+
+} // namespace
+
+Parser::Parser() : pos_(0) {}
 
 Parser::Parser(const std::vector<Token>& tokens) : tokens_(tokens), pos_(0) {}
 
-Token Parser::peek() {
-    if (pos_ < tokens_.size()) {
-        return tokens_[pos_];
+Parser::Parser(std::vector<Token>&& tokens) : tokens_(std::move(tokens)), pos_(0) {}
+
+Parser::Parser(CanalTokens& canal) : pos_(0), canal_(&canal) {}
+
+// Volta ao estado inicial mantendo a capacidade dos buffers e dos mapas de
+// escopo. Os tokens são trocados com `tokens`, que recebe o vetor anterior.
+void Parser::reiniciar(std::vector<Token>& tokens) {
+    tokens_.swap(tokens);
+    pos_ = 0;
+    canal_ = nullptr;
+    recebidos_.clear();
+    canal_esgotado_ = false;
+    while (profundidade_ > 0) {
+        sairEscopo();
+    }
+    funcoes_.clear();
+    funcao_atual_ = nullptr;
+    escopo_funcao_ = 0;
+    escopo_funcao_externa_ = 0;
+    diagnosticos_.clear();
+    dependencias_.clear();
+    modulos_importados_.clear();
+    variaveis_importadas_.clear();
+    funcoes_importadas_.clear();
+}
+
+void Parser::usarSaida(bool verboso) {
+    verboso_ = verboso;
+}
+
+void Parser::usarSaida(std::ostream& saida, std::ostream& erros) {
+    saida_ = &saida;
+    erros_ = &erros;
+}
+
+const std::vector<Diagnostico>& Parser::diagnosticos() const {
+    return diagnosticos_;
+}
+
+void Parser::usarModulos(CarregadorModulos* modulos, const std::string& diretorio) {
+    modulos_ = modulos;
+    diretorio_ = diretorio;
+}
+
+InterfaceModulo Parser::interface() const {
+    InterfaceModulo interface;
+    if (profundidade_ > 0) {
+        for (const auto& [nome, simbolo] : escopos_[0]) {
+            if (!variaveis_importadas_.count(nome)) {
+                interface.variaveis.emplace_back(nome, simbolo);
+            }
+        }
+    }
+    for (const auto& [nome, funcao] : funcoes_) {
+        if (!funcoes_importadas_.count(nome)) {
+            interface.funcoes.emplace_back(nome, funcao);
+        }
     }
-    return {FIM_ARQUIVO, ""};
+    return interface;
+}
+
+const std::vector<DependenciaModulo>& Parser::dependencias() const {
+    return dependencias_;
 }
 
-Token Parser::advance() {
-    if (pos_ < tokens_.size()) {
-        return tokens_[pos_++];
+void Parser::usarPrograma(Programa* programa, bool expandir_folhas) {
+    programa_ = programa;
+    expandir_folhas_ = expandir_folhas;
+    if (programa_ && programa_->blocos.empty()) {
+        programa_->blocos.push_back({"programa", 0, 0});
     }
-    return {FIM_ARQUIVO, ""};
+}
+
+const Token Parser::fim_ = {FIM_ARQUIVO, ""};
+
+const Token& Parser::peek() {
+    return token_em(pos_);
+}
+
+const Token& Parser::peek_seguinte() {
+    return token_em(pos_ + 1);
+}
+
+const Token& Parser::advance() {
+    const Token& t = token_em(pos_);
+    if (&t != &fim_) {
+        pos_++;
+    }
+    return t;
+}
+
+const Token& Parser::token_em(size_t i) {
+    if (!canal_) {
+        return i < tokens_.size() ? tokens_[i] : fim_;
+    }
+
+    // No modo pipeline os tokens chegam do canal sob demanda. Ficam num deque
+    // porque os métodos de parse guardam referências a tokens já lidos.
+    Token token;
+    while (i >= recebidos_.size() && !canal_esgotado_) {
+        if (!canal_->receber(token) || token.tipo == ERRO) {
+            canal_esgotado_ = true; // o erro léxico é reportado por quem roda o lexer
+        } else {
+            recebidos_.push_back(std::move(token));
+        }
+    }
+    return i < recebidos_.size() ? recebidos_[i] : fim_;
 }
 
 bool Parser::match(TokenTipo tipo) {
@@ -25,9 +135,6 @@ bool Parser::match(TokenTipo tipo) {
     return false;
 }
 
-void Parser::erro(const std::string& msg) {
-    std::cerr << "\033[1;31mErro de sintaxe: " << msg << "\033[0m" << std::endl;
-}
 
 /* anterior; o compilador para apos achar o primeiro erro
 bool Parser::parse() {
@@ -43,6 +150,11 @@ bool Parser::parse() {
 bool Parser::parse() {
     bool sucesso = true;
 
+    // Escopo global explícito: assim profundidade_ == 1 é sempre o nível de topo
+    if (profundidade_ == 0) {
+        entrarEscopo();
+    }
+
     while (peek().tipo != FIM_ARQUIVO) {
         if (!parse_comando()) {
             sucesso = false; // continua, mesmo após erro
@@ -54,7 +166,8 @@ bool Parser::parse() {
 //*/
 
 bool Parser::parse_comando() {
-    Token t = peek();
+    const Token& t = peek();
+    linha_comando_ = t.linha;
 
     switch (t.tipo) {
         case VAR:
@@ -71,8 +184,17 @@ bool Parser::parse_comando() {
             return parse_for();
         case FUNC:
             return parse_func();
+        case RETURN:
+            return parse_return();
+        case IMPORT:
+            return parse_import();
+        case IDENTIFICADOR:
+            if (peek_seguinte().tipo == ABRE_PARENTESE) {
+                return parse_chamada_comando();
+            }
+            [[fallthrough]];
         default:
-            erro("Comando inesperado: " + t.valor);
+            erroNaLinha(t.linha, "Comando inesperado: ", t.valor);
             advance();
             return false;
     }
@@ -85,7 +207,7 @@ bool Parser::parse_declaracao() {
         return false;
     }
 
-    Token id = peek();
+    const Token& id = peek();
     if (!match(IDENTIFICADOR)) {
         erro("Esperado identificador depois de 'var'");
         return false;
@@ -96,7 +218,7 @@ bool Parser::parse_declaracao() {
         return false;
     }
 
-    Token tipo = peek();
+    const Token& tipo = peek();
     if (!(match(INT) || match(FLOAT) || match(CHAR) || match(BOOL) || match(STRING))) {
         erro("Esperado tipo de dado (int, float, char, bool, string)");
         return false;
@@ -104,45 +226,64 @@ bool Parser::parse_declaracao() {
 
     // Verifica se a variável já foi declarada
     if(!declararVariavel(id.valor, tipo.valor)){
-        erro("Variável '" + id.valor + "' já foi declarada.");
+        erro("Variável '", id.valor, "' já foi declarada.");
         return false;
     }
 
     bool tem_valor = false;
-    Token val;
+    const Token* val = &fim_;
+    Operando slot = buscaVariavel(id.valor)->operando;
 
     if (match(IGUAL)) {
         tem_valor = true;
-        val = peek();
-        if (!(match(NUMERO) || match(TEXTO) || match(IDENTIFICADOR) || match(CHAR))) {
+        val = &peek();
+        if (val->tipo == IDENTIFICADOR && peek_seguinte().tipo == ABRE_PARENTESE) {
+            std::string retorno;
+            if (!parse_chamada(retorno, slot)) {
+                return false;
+            }
+            if (retorno != tipo.valor) {
+                erro("Tipo incompatível: função '", val->valor, "' retorna ", retorno, " em variável '", id.valor, "' do tipo ", tipo.valor);
+                return false;
+            }
+        } else if (val->tipo == NUMERO_INTEIRO || val->tipo == NUMERO_REAL || val->tipo == TEXTO || val->tipo == IDENTIFICADOR || val->tipo == CHAR) {
+            std::string tipo_valor;
+            Operando origem;
+            if (!parse_valor(tipo_valor, origem)) {
+                return false;
+            }
+            if (val->tipo == IDENTIFICADOR && tipo_valor != tipo.valor) {
+                erro("Tipo incompatível: valor ", tipo_valor, " em variável '", id.valor, "' do tipo ", tipo.valor);
+                return false;
+            }
+            emite({OP_COPIA, slot, origem});
+        } else {
             erro("Esperado valor após '='");
             return false;
         }
 
         // 🔍 Verificações semânticas por tipo
-        if (val.tipo == NUMERO) {
-            if (val.valor.find('.') != std::string::npos) {
-                if (tipo.valor != "float") {
-                    erro("Tipo incompatível: valor decimal em variável '" + id.valor + "' do tipo " + tipo.valor);
-                    return false;
-                }
-            } else {
-                if (tipo.valor != "int") {
-                    erro("Tipo incompatível: valor inteiro em variável '" + id.valor + "' do tipo " + tipo.valor);
-                    return false;
-                }
-            }
+        if (val->tipo == NUMERO_REAL && tipo.valor != "float") {
+            erro("Tipo incompatível: valor decimal em variável '", id.valor, "' do tipo ", tipo.valor);
+            return false;
         }
 
-        if (val.tipo == TEXTO && tipo.valor != "string") {
-            erro("Tipo incompatível: valor textual em variável '" + id.valor + "' do tipo " + tipo.valor);
+        if (val->tipo == NUMERO_INTEIRO && tipo.valor != "int") {
+            erro("Tipo incompatível: valor inteiro em variável '", id.valor, "' do tipo ", tipo.valor);
             return false;
         }
 
-        if (val.tipo == CHAR && tipo.valor != "char") {
-            erro("Tipo incompatível: valor char em variável '" + id.valor + "' do tipo " + tipo.valor);
+        if (val->tipo == TEXTO && tipo.valor != "string") {
+            erro("Tipo incompatível: valor textual em variável '", id.valor, "' do tipo ", tipo.valor);
             return false;
         }
+
+        if (val->tipo == CHAR && tipo.valor != "char") {
+            erro("Tipo incompatível: valor char em variável '", id.valor, "' do tipo ", tipo.valor);
+            return false;
+        }
+    } else {
+        emite({OP_COPIA, slot, constante(tipo.valor)});
     }
 
     if (!match(PONTO_E_VIRGULA)) {
@@ -150,11 +291,8 @@ bool Parser::parse_declaracao() {
         return false;
     }
 
-    std::cout << "\033[1;32mDeclaração reconhecida:\033[0m var " << id.valor << " : " << tipo.valor;
-    if (tem_valor) {
-        std::cout << " = " << val.valor;
-    }
-    std::cout << ";" << std::endl;
+    anuncia("\033[1;32mDeclaração reconhecida:\033[0m var ", id.valor, " : ", tipo.valor,
+            tem_valor ? " = " : "", val->valor, ";");
 
     return true;
 }
@@ -172,14 +310,17 @@ bool Parser::parse_print() {
     }
 
     // Verifica se o conteúdo do print é válido e, se for identificador, se foi declarado
+    Operando operando;
     if (peek().tipo == IDENTIFICADOR) {
-        if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada antes do uso em print");
+        const Simbolo* simbolo = buscaVariavel(peek().valor);
+        if (!simbolo) {
+            erro("Variável '", peek().valor, "' não declarada antes do uso em print");
             return false;
         }
+        operando = simbolo->operando;
         advance();
-    } else if (peek().tipo == TEXTO || peek().tipo == NUMERO) {
-        advance();
+    } else if (peek().tipo == TEXTO || peek().tipo == NUMERO_INTEIRO || peek().tipo == NUMERO_REAL) {
+        operando = constante(advance());
     } else {
         erro("Esperado valor para print");
         return false;
@@ -195,7 +336,8 @@ bool Parser::parse_print() {
         return false;
     }
 
-    std::cout << "\033[1;32mComando print reconhecido\033[0m" << std::endl;
+    emite({OP_PRINT, operando});
+    anuncia("\033[1;32mComando print reconhecido\033[0m");
     return true;
 }
 
@@ -212,11 +354,14 @@ bool Parser::parse_input() {
     }
 
     // Verifica se identificador foi declarado
+    Operando operando;
     if (peek().tipo == IDENTIFICADOR) {
-        if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada antes do uso em input");
+        const Simbolo* simbolo = buscaVariavel(peek().valor);
+        if (!simbolo) {
+            erro("Variável '", peek().valor, "' não declarada antes do uso em input");
             return false;
         }
+        operando = simbolo->operando;
         advance();
     } else {
         erro("Esperado identificador dentro do input");
@@ -233,12 +378,14 @@ bool Parser::parse_input() {
         return false;
     }
 
-    std::cout << "\033[1;32mComando input reconhecido\033[0m" << std::endl;
+    emite({OP_INPUT, operando});
+    anuncia("\033[1;32mComando input reconhecido\033[0m");
     return true;
 }
 
 // if (<condição>) { <comandos> } [else { <comandos> }]
 bool Parser::parse_if() {
+    int linha = peek().linha;
     if (!match(IF)) {
         erro("Esperado 'if'");
         return false;
@@ -249,14 +396,17 @@ bool Parser::parse_if() {
         return false;
     }
 
+    Operando condicao;
     if (peek().tipo == IDENTIFICADOR) {
-        if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada na condição do if");
+        const Simbolo* simbolo = buscaVariavel(peek().valor);
+        if (!simbolo) {
+            erro("Variável '", peek().valor, "' não declarada na condição do if");
             return false;
         }
+        condicao = simbolo->operando;
         advance();
-    } else if (peek().tipo == NUMERO) {
-        advance();
+    } else if (peek().tipo == NUMERO_INTEIRO || peek().tipo == NUMERO_REAL) {
+        condicao = constante(advance());
     } else {
         erro("Esperado condição dentro do if");
         return false;
@@ -272,6 +422,8 @@ bool Parser::parse_if() {
         return false;
     }
 
+    uint32_t salto_else = emite({OP_SALTA_SE_FALSO, condicao});
+    uint32_t bloco_externo = abreBloco("if", linha);
     entrarEscopo();
 
     while (peek().tipo != FECHA_CHAVE && peek().tipo != FIM_ARQUIVO) {
@@ -289,12 +441,19 @@ bool Parser::parse_if() {
 
     sairEscopo();
 
+    int linha_else = peek().linha;
     if (match(ELSE)) {
         if (!match(ABRE_CHAVE)) {
             erro("Esperado '{' após else");
             return false;
         }
 
+        // Fim do bloco do if: pula o else
+        linha_comando_ = linha;
+        uint32_t salto_fim = emite({OP_SALTA});
+        fechaBloco(bloco_externo, linha);
+        corrigeSalto(salto_else);
+        abreBloco("else", linha_else);
         entrarEscopo();
 
         while (peek().tipo != FECHA_CHAVE && peek().tipo != FIM_ARQUIVO) {
@@ -311,14 +470,20 @@ bool Parser::parse_if() {
         }
 
         sairEscopo();
+        fechaBloco(bloco_externo, linha);
+        corrigeSalto(salto_fim);
+    } else {
+        fechaBloco(bloco_externo, linha);
+        corrigeSalto(salto_else);
     }
 
-    std::cout << "\033[1;32mComando if/else reconhecido\033[0m" << std::endl;
+    anuncia("\033[1;32mComando if/else reconhecido\033[0m");
     return true;
 }
 
 // while (<condição>) { <comandos> }
 bool Parser::parse_while() {
+    int linha = peek().linha;
     if (!match(WHILE)) {
         erro("Esperado 'while'");
         return false;
@@ -329,14 +494,17 @@ bool Parser::parse_while() {
         return false;
     }
 
+    Operando condicao;
     if (peek().tipo == IDENTIFICADOR) {
-        if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada na condição do while");
+        const Simbolo* simbolo = buscaVariavel(peek().valor);
+        if (!simbolo) {
+            erro("Variável '", peek().valor, "' não declarada na condição do while");
             return false;
         }
+        condicao = simbolo->operando;
         advance();
-    } else if (peek().tipo == NUMERO) {
-        advance();
+    } else if (peek().tipo == NUMERO_INTEIRO || peek().tipo == NUMERO_REAL) {
+        condicao = constante(advance());
     } else {
         erro("Esperado condição no while");
         return false;
@@ -352,6 +520,9 @@ bool Parser::parse_while() {
         return false;
     }
 
+    // A condição é só um operando, então o laço volta direto para o teste
+    uint32_t teste = emite({OP_SALTA_SE_FALSO, condicao});
+    uint32_t bloco_externo = abreBloco("while", linha);
     entrarEscopo();
 
     while (peek().tipo != FECHA_CHAVE && peek().tipo != FIM_ARQUIVO) {
@@ -368,13 +539,18 @@ bool Parser::parse_while() {
     }
 
     sairEscopo();
+    linha_comando_ = linha;
+    emite({OP_SALTA, {}, {}, teste});
+    fechaBloco(bloco_externo, linha);
+    corrigeSalto(teste);
 
-    std::cout << "\033[1;32mComando while reconhecido\033[0m" << std::endl;
+    anuncia("\033[1;32mComando while reconhecido\033[0m");
     return true;
 }
 
 // for (<var decl>; <condição>; <incremento>) { <comandos> }
 bool Parser::parse_for() {
+    int linha = peek().linha;
     if (!match(FOR)) {
         erro("Esperado 'for'");
         return false;
@@ -394,15 +570,18 @@ bool Parser::parse_for() {
     }
 
     // Condição
+    Operando condicao;
     if (peek().tipo == IDENTIFICADOR) {
-        if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada na condição do 'for'");
+        const Simbolo* simbolo = buscaVariavel(peek().valor);
+        if (!simbolo) {
+            erro("Variável '", peek().valor, "' não declarada na condição do 'for'");
             sairEscopo();
             return false;
         }
+        condicao = simbolo->operando;
         advance();
-    } else if (peek().tipo == NUMERO) {
-        advance();
+    } else if (peek().tipo == NUMERO_INTEIRO || peek().tipo == NUMERO_REAL) {
+        condicao = constante(advance());
     } else {
         erro("Esperado condição válida no 'for'");
         sairEscopo();
@@ -418,7 +597,7 @@ bool Parser::parse_for() {
     // Incremento
     if (peek().tipo == IDENTIFICADOR) {
         if (!variavelDeclarada(peek().valor)) {
-            erro("Variável '" + peek().valor + "' não declarada no incremento do 'for'");
+            erro("Variável '", peek().valor, "' não declarada no incremento do 'for'");
             sairEscopo();
             return false;
         }
@@ -441,6 +620,10 @@ bool Parser::parse_for() {
         return false;
     }
 
+    // O incremento ainda não gera código: a linguagem não tem expressões
+    uint32_t teste = emite({OP_SALTA_SE_FALSO, condicao});
+    uint32_t bloco_externo = abreBloco("for", linha);
+
     while (peek().tipo != FECHA_CHAVE && peek().tipo != FIM_ARQUIVO) {
         if (!parse_comando()) {
             sairEscopo();
@@ -454,32 +637,69 @@ bool Parser::parse_for() {
         return false;
     }
 
+    linha_comando_ = linha;
+    emite({OP_SALTA, {}, {}, teste});
+    fechaBloco(bloco_externo, linha);
+    corrigeSalto(teste);
+
     sairEscopo();  // Fecha escopo do for inteiro (declaração + corpo)
 
-    std::cout << "\033[1;32mComando for reconhecido\033[0m" << std::endl;
+    anuncia("\033[1;32mComando for reconhecido\033[0m");
     return true;
 }
 
-// func <id> () { <comandos> }
+// func <id> ( [<id> : <tipo> {, <id> : <tipo>}] ) : <tipo> { <comandos> }
 bool Parser::parse_func() {
     if (!match(FUNC)) {
         erro("Esperado 'func'");
         return false;
     }
 
-    Token nome = peek();
+    const Token& nome = peek();
     if (!match(IDENTIFICADOR)) {
         erro("Esperado identificador após 'func'");
         return false;
     }
 
+    if (funcoes_.count(nome.valor)) {
+        erro("Função '", nome.valor, "' já foi declarada.");
+        return false;
+    }
+
     if (!match(ABRE_PARENTESE)) {
         erro("Esperado '(' após nome da função");
         return false;
     }
 
+    // Parâmetros: só são declarados no escopo do corpo, depois do '{'
+    std::vector<const Token*> nomes_parametros;
+    std::vector<std::string> tipos_parametros;
+    if (peek().tipo != FECHA_PARENTESE) {
+        do {
+            const Token& parametro = peek();
+            if (!match(IDENTIFICADOR)) {
+                erro("Esperado nome do parâmetro da função '", nome.valor, "'");
+                return false;
+            }
+
+            if (!match(DOIS_PONTOS)) {
+                erro("Esperado ':' após o parâmetro '", parametro.valor, "'");
+                return false;
+            }
+
+            const Token& tipo_parametro = peek();
+            if (!(match(INT) || match(FLOAT) || match(CHAR) || match(BOOL) || match(STRING))) {
+                erro("Esperado tipo do parâmetro '", parametro.valor, "' (int, float, char, bool, string)");
+                return false;
+            }
+
+            nomes_parametros.push_back(&parametro);
+            tipos_parametros.push_back(tipo_parametro.valor);
+        } while (match(VIRGULA));
+    }
+
     if (!match(FECHA_PARENTESE)) {
-        erro("Esperado ')' após '(' da função");
+        erro("Esperado ')' após os parâmetros da função");
         return false;
     }
 
@@ -488,7 +708,7 @@ bool Parser::parse_func() {
         return false;
     }
 
-    Token tipo = peek();
+    const Token& tipo = peek();
     if (!(match(INT) || match(FLOAT) || match(CHAR) || match(BOOL) || match(STRING) || match(VOID))) {
         erro("Esperado tipo de retorno da função (int, float, char, bool, string ou void)");
         return false;
@@ -499,57 +719,505 @@ bool Parser::parse_func() {
         return false;
     }
 
-    entrarEscopo(); // Escopo do corpo da função
+    // Registrada antes do corpo para permitir chamadas recursivas
+    Funcao& funcao = funcoes_[nome.valor];
+    funcao.retorno = tipo.valor;
+    funcao.parametros = std::move(tipos_parametros);
+
+    // O corpo fica no meio do código; quem passa pela definição pula ele
+    uint32_t pula_corpo = emite({OP_SALTA});
+    uint32_t bloco_externo = abreBloco("func " + nome.valor, nome.linha);
+    if (programa_) {
+        funcao.indice = static_cast<uint32_t>(programa_->funcoes.size());
+        programa_->funcoes.push_back({aqui(), static_cast<uint32_t>(funcao.parametros.size()), 0, bloco_atual_});
+    }
+
+    Funcao* anterior = funcao_atual_;
+    size_t escopo_anterior = escopo_funcao_;
+    funcao_atual_ = &funcao;
+
+    entrarEscopo(); // Escopo do corpo da função, já com os parâmetros
+    escopo_funcao_ = profundidade_ - 1;
+    if (!anterior) {
+        escopo_funcao_externa_ = escopo_funcao_;
+    }
+
+    // Os parâmetros ocupam os primeiros slots locais, na ordem da declaração
+    for (size_t i = 0; i < nomes_parametros.size(); i++) {
+        if (!declararVariavel(nomes_parametros[i]->valor, funcao.parametros[i])) {
+            erro("Parâmetro '", nomes_parametros[i]->valor, "' repetido na função '", nome.valor, "'");
+            funcao_atual_ = anterior;
+            escopo_funcao_ = escopo_anterior;
+            sairEscopo();
+            return false;
+        }
+    }
 
     while (peek().tipo != FECHA_CHAVE && peek().tipo != FIM_ARQUIVO) {
         if (!parse_comando()) {
+            funcao_atual_ = anterior;
+            escopo_funcao_ = escopo_anterior;
             sairEscopo();
             return false;
         }
     }
 
+    linha_comando_ = nome.linha;
+    // Fim do corpo sem return: função void volta sem valor; as outras
+    // devolvem o valor padrão do tipo, senão o destino de quem chamou
+    // ficaria com o que tinha antes, talvez de outro tipo
+    emite({OP_RETORNA, funcao.retorno == "void" ? Operando{} : constante(funcao.retorno)});
+    fechaBloco(bloco_externo, nome.linha);
+    if (programa_) {
+        // Folha pequena: não chama ninguém nem define funções no corpo
+        uint32_t inicio = programa_->funcoes[funcao.indice].inicio;
+        funcao.fim = aqui();
+        funcao.expansivel = expandir_folhas_ && funcao.fim - inicio <= LIMITE_EXPANSAO &&
+                            programa_->funcoes.size() == funcao.indice + 1;
+        for (uint32_t i = inicio; i < funcao.fim && funcao.expansivel; i++) {
+            funcao.expansivel = programa_->codigo[i].op != OP_CHAMA;
+        }
+    }
+    funcao_atual_ = anterior;
+    escopo_funcao_ = escopo_anterior;
     sairEscopo();
+    corrigeSalto(pula_corpo);
 
     if (!match(FECHA_CHAVE)) {
         erro("Esperado '}' para fechar bloco da função");
         return false;
     }
 
-    std::cout << "\033[1;32mFunção reconhecida\033[0m" << std::endl;
+    if (funcao.retorno != "void" && !funcao.tem_retorno) {
+        erro("Função '", nome.valor, "' do tipo ", funcao.retorno, " não tem 'return'");
+        return false;
+    }
+
+    anuncia("\033[1;32mFunção reconhecida\033[0m");
+    return true;
+}
+
+// return [<valor>] ;
+bool Parser::parse_return() {
+    if (!match(RETURN)) {
+        erro("Esperado 'return'");
+        return false;
+    }
+
+    if (!funcao_atual_) {
+        erro("'return' fora de uma função");
+        return false;
+    }
+
+    funcao_atual_->tem_retorno = true;
+
+    Operando operando;
+    if (peek().tipo == PONTO_E_VIRGULA) {
+        if (funcao_atual_->retorno != "void") {
+            erro("Esperado valor de retorno do tipo ", funcao_atual_->retorno);
+            return false;
+        }
+    } else {
+        std::string tipo;
+        if (!parse_valor(tipo, operando)) {
+            return false;
+        }
+
+        if (tipo != funcao_atual_->retorno) {
+            erro("Tipo incompatível: retorno ", tipo, " em função do tipo ", funcao_atual_->retorno);
+            return false;
+        }
+    }
+
+    if (!match(PONTO_E_VIRGULA)) {
+        erro("Esperado ';' após return");
+        return false;
+    }
+
+    emite({OP_RETORNA, operando});
+    anuncia("\033[1;32mComando return reconhecido\033[0m");
+    return true;
+}
+
+// import "<arquivo>";
+bool Parser::parse_import() {
+    if (!match(IMPORT)) {
+        erro("Esperado 'import'");
+        return false;
+    }
+
+    const Token& arquivo = peek();
+    if (!match(TEXTO)) {
+        erro("Esperado nome do arquivo entre aspas após 'import'");
+        return false;
+    }
+
+    if (!match(PONTO_E_VIRGULA)) {
+        erro("Esperado ';' após import");
+        return false;
+    }
+
+    if (funcao_atual_ || profundidade_ > 1) {
+        erro("'import' só é permitido fora de blocos e funções");
+        return false;
+    }
+
+    if (!modulos_) {
+        erro("'import' indisponível: nenhum carregador de módulos configurado");
+        return false;
+    }
+
+    // O mesmo módulo importado de novo, por qualquer caminho, não muda nada.
+    // Só os imports deste arquivo contam: os indiretos não declararam nomes aqui.
+    if (!modulos_importados_.insert(CarregadorModulos::caminho_canonico(arquivo.valor, diretorio_)).second) {
+        anuncia("\033[1;32mImport repetido ignorado:\033[0m ", arquivo.valor);
+        return true;
+    }
+
+    // Com geração de código, o código do módulo vai para o mesmo Programa,
+    // aqui onde ele é importado
+    InterfaceModulo interface;
+    std::string mensagem;
+    if (!modulos_->carregar(arquivo.valor, diretorio_, programa_, interface, dependencias_, mensagem)) {
+        erro(mensagem);
+        return false;
+    }
+
+    for (const auto& [nome, simbolo] : interface.variaveis) {
+        if (!declararVariavel(nome, simbolo)) {
+            erro("Variável '", nome, "' importada de '", arquivo.valor, "' já foi declarada.");
+            return false;
+        }
+        variaveis_importadas_.insert(nome);
+    }
+
+    for (auto& [nome, funcao] : interface.funcoes) {
+        if (funcoes_.count(nome)) {
+            erro("Função '", nome, "' importada de '", arquivo.valor, "' já foi declarada.");
+            return false;
+        }
+        funcoes_[nome] = std::move(funcao);
+        funcoes_importadas_.insert(nome);
+    }
+
+    anuncia("\033[1;32mImport reconhecido:\033[0m ", arquivo.valor);
+    return true;
+}
+
+// <id> ( <argumentos> ) ;
+bool Parser::parse_chamada_comando() {
+    std::string tipo;
+    if (!parse_chamada(tipo, {})) {
+        return false;
+    }
+
+    if (!match(PONTO_E_VIRGULA)) {
+        erro("Esperado ';' após chamada de função");
+        return false;
+    }
+
+    anuncia("\033[1;32mChamada de função reconhecida\033[0m");
+    return true;
+}
+
+// <id> ( [<valor> {, <valor>}] ), devolvendo em `tipo` o tipo de retorno.
+// O código gerado guarda o retorno em `destino`, se houver.
+bool Parser::parse_chamada(std::string& tipo, Operando destino) {
+    const Token& nome = peek();
+    if (!match(IDENTIFICADOR)) {
+        erro("Esperado nome da função");
+        return false;
+    }
+
+    auto it = funcoes_.find(nome.valor);
+    if (it == funcoes_.end()) {
+        erro("Função '", nome.valor, "' não declarada antes da chamada");
+        return false;
+    }
+    const Funcao& funcao = it->second;
+
+    if (!match(ABRE_PARENTESE)) {
+        erro("Esperado '(' após nome da função '", nome.valor, "'");
+        return false;
+    }
+
+    // Argumentos que são chamadas geram código antes desta chamada, então os
+    // operandos esperam em argumentos_pendentes_ até todos serem avaliados
+    size_t argumentos = 0;
+    size_t inicio_pendentes = argumentos_pendentes_.size();
+    if (peek().tipo != FECHA_PARENTESE) {
+        do {
+            std::string tipo_argumento;
+            Operando argumento;
+            if (!parse_valor(tipo_argumento, argumento)) {
+                return false;
+            }
+            if (programa_) {
+                argumentos_pendentes_.push_back(argumento);
+            }
+
+            if (argumentos < funcao.parametros.size() && tipo_argumento != funcao.parametros[argumentos]) {
+                erro("Tipo incompatível: argumento ", argumentos + 1, " de '", nome.valor, "' espera ",
+                     funcao.parametros[argumentos], " e recebeu ", tipo_argumento);
+                return false;
+            }
+            argumentos++;
+        } while (match(VIRGULA));
+    }
+
+    if (!match(FECHA_PARENTESE)) {
+        erro("Esperado ')' após argumentos da função '", nome.valor, "'");
+        return false;
+    }
+
+    if (argumentos != funcao.parametros.size()) {
+        erro("Função '", nome.valor, "' espera ", funcao.parametros.size(), " argumento(s) e recebeu ", argumentos);
+        return false;
+    }
+
+    if (programa_ && funcao.expansivel) {
+        expandeChamada(funcao, inicio_pendentes, destino);
+        argumentos_pendentes_.resize(inicio_pendentes);
+    } else if (programa_) {
+        uint32_t inicio = static_cast<uint32_t>(programa_->argumentos.size());
+        programa_->argumentos.insert(programa_->argumentos.end(), argumentos_pendentes_.begin() + inicio_pendentes,
+                                     argumentos_pendentes_.end());
+        argumentos_pendentes_.resize(inicio_pendentes);
+        emite({OP_CHAMA, destino, {}, funcao.indice, inicio});
+    }
+
+    tipo = funcao.retorno;
+    return true;
+}
+
+// Literal, variável ou chamada de função, devolvendo seu tipo em `tipo`.
+// Chamadas deixam o resultado num slot temporário.
+bool Parser::parse_valor(std::string& tipo, Operando& operando) {
+    const Token& t = peek();
+    switch (t.tipo) {
+        case NUMERO_INTEIRO:
+            tipo = "int";
+            break;
+        case NUMERO_REAL:
+            tipo = "float";
+            break;
+        case TEXTO:
+            tipo = "string";
+            break;
+        case CHAR:
+            tipo = "char";
+            break;
+        case IDENTIFICADOR: {
+            if (peek_seguinte().tipo == ABRE_PARENTESE) {
+                operando = novoSlot();
+                return parse_chamada(tipo, operando);
+            }
+            if (t.valor == "true" || t.valor == "false") {
+                tipo = "bool";
+                break;
+            }
+            const Simbolo* simbolo = buscaVariavel(t.valor);
+            if (!simbolo) {
+                erro("Variável '", t.valor, "' não declarada antes do uso");
+                return false;
+            }
+            tipo = simbolo->tipo;
+            operando = simbolo->operando;
+            advance();
+            return true;
+        }
+        default:
+            erro("Esperado valor, variável ou chamada de função");
+            return false;
+    }
+
+    operando = constante(advance());
     return true;
 }
 
 void Parser::entrarEscopo() {
-    escopos_.emplace_back(); // adiciona um novo mapa vazio no topo da pilha
+    EscopoFase fase(FASE_ESCOPO);
+    // Reaproveita o mapa de um escopo já encerrado (mantém os buckets alocados)
+    if (profundidade_ == escopos_.size()) {
+        escopos_.emplace_back();
+    }
+    profundidade_++;
 }
 
 void Parser::sairEscopo() {
-    if (!escopos_.empty()) {
-        escopos_.pop_back();
+    if (profundidade_ > 0) {
+        profundidade_--;
+        escopos_[profundidade_].clear();
     }
 }
 
 bool Parser::declararVariavel(const std::string& nome, const std::string& tipo) {
-    if (escopos_.empty()) entrarEscopo(); // cria um escopo global se não houver nenhum
+    if (profundidade_ == 0) entrarEscopo(); // cria um escopo global se não houver nenhum
 
-    auto& atual = escopos_.back();
+    EscopoFase fase(FASE_ESCOPO);
+    auto& atual = escopos_[profundidade_ - 1];
     if (atual.count(nome)) return false; // já existe no escopo atual
 
-    atual[nome] = tipo;
+    atual[nome] = {tipo, novoSlot()};
     return true;
 }
 
+bool Parser::declararVariavel(const std::string& nome, const Simbolo& simbolo) {
+    if (profundidade_ == 0) entrarEscopo();
+
+    EscopoFase fase(FASE_ESCOPO);
+    return escopos_[profundidade_ - 1].emplace(nome, simbolo).second;
+}
+
 bool Parser::variavelDeclarada(const std::string& nome) {
-    for (auto it = escopos_.rbegin(); it != escopos_.rend(); ++it) {
-        if (it->count(nome)) return true;
+    return buscaVariavel(nome) != nullptr;
+}
+
+const Simbolo* Parser::buscaVariavel(const std::string& nome) {
+    for (size_t i = profundidade_; i > 0; i--) {
+        auto found = escopos_[i - 1].find(nome);
+        if (found == escopos_[i - 1].end()) continue;
+        // Os locais de uma função que envolve a atual não existem no quadro
+        // dela: ficam de fora os escopos entre o começo da função mais
+        // externa e o da atual. Decidido só pela profundidade, para a
+        // validação e a geração de código aceitarem os mesmos programas.
+        if (funcao_atual_ && i - 1 >= escopo_funcao_externa_ && i - 1 < escopo_funcao_) continue;
+        return &found->second;
     }
-    return false;
+    return nullptr;
+}
+
+uint32_t Parser::emite(const Instrucao& instrucao) {
+    if (!programa_) return 0;
+    programa_->codigo.push_back(instrucao);
+    programa_->bloco_instrucao.push_back(bloco_atual_);
+    programa_->linha_instrucao.push_back(linha_comando_);
+    return static_cast<uint32_t>(programa_->codigo.size() - 1);
+}
+
+// O rótulo do bloco leva a linha: "while:12"
+uint32_t Parser::abreBloco(const std::string& rotulo, int linha) {
+    uint32_t anterior = bloco_atual_;
+    if (!programa_) return anterior;
+    programa_->blocos.push_back({rotulo + ":" + std::to_string(linha), linha, anterior});
+    bloco_atual_ = static_cast<uint32_t>(programa_->blocos.size() - 1);
+    return anterior;
+}
+
+// Volta para o bloco de fora; `linha` é a do comando que abriu o bloco
+void Parser::fechaBloco(uint32_t anterior, int linha) {
+    bloco_atual_ = anterior;
+    linha_comando_ = linha;
 }
 
-std::string Parser::tipoVariavel(const std::string& nome) {
-    for (auto it = escopos_.rbegin(); it != escopos_.rend(); ++it) {
-        auto found = it->find(nome);
-        if (found != it->end()) return found->second;
+uint32_t Parser::aqui() const {
+    return programa_ ? static_cast<uint32_t>(programa_->codigo.size()) : 0;
+}
+
+void Parser::corrigeSalto(uint32_t instrucao) {
+    if (programa_) programa_->codigo[instrucao].n = aqui();
+}
+
+// Globais no começo da pilha do Processo; dentro de função, relativo ao quadro
+Operando Parser::novoSlot() {
+    if (!programa_) return {};
+    if (funcao_atual_) return {OPERANDO_LOCAL, programa_->funcoes[funcao_atual_->indice].num_locais++};
+    return {OPERANDO_GLOBAL, programa_->num_globais++};
+}
+
+Operando Parser::constante(const Token& literal) {
+    if (!programa_) return {};
+    auto& constantes = programa_->constantes;
+    switch (literal.tipo) {
+        case NUMERO_INTEIRO: constantes.emplace_back(literal.inteiro); break;
+        case NUMERO_REAL: constantes.emplace_back(literal.real); break;
+        case TEXTO: constantes.emplace_back(literal.valor); break;
+        case CHAR: constantes.emplace_back(literal.valor.empty() ? '\0' : literal.valor[0]); break;
+        default: constantes.emplace_back(literal.valor == "true"); break;
     }
-    return "";
+    return {OPERANDO_CONSTANTE, static_cast<uint32_t>(constantes.size() - 1)};
+}
+
+// Copia o corpo de uma função folha no lugar da chamada. Os locais dela
+// viram slots novos de quem chama, os argumentos são copiados para os
+// parâmetros e cada return vira uma cópia para `destino` seguida de um salto
+// para o fim da cópia. Para o perfil, os blocos do corpo (a própria função e
+// os if/while dentro dela) também são copiados para dentro do bloco da chamada.
+void Parser::expandeChamada(const Funcao& funcao, size_t primeiro_argumento, Operando destino) {
+    FuncaoCompilada compilada = programa_->funcoes[funcao.indice];
+    uint32_t tamanho = funcao.fim - compilada.inicio;
+
+    // Os blocos do corpo são contíguos, a partir do bloco da função
+    uint32_t bloco_externo = bloco_atual_;
+    uint32_t ultimo_bloco = compilada.bloco;
+    for (uint32_t i = 0; i < tamanho; i++) {
+        ultimo_bloco = std::max(ultimo_bloco, programa_->bloco_instrucao[compilada.inicio + i]);
+    }
+    uint32_t copia = static_cast<uint32_t>(programa_->blocos.size());
+    for (uint32_t b = compilada.bloco; b <= ultimo_bloco; b++) {
+        BlocoFonte bloco = programa_->blocos[b];
+        bloco.pai = b == compilada.bloco ? bloco_externo : copia + (bloco.pai - compilada.bloco);
+        programa_->blocos.push_back(std::move(bloco));
+    }
+    bloco_atual_ = copia;
+
+    Operando base;
+    for (uint32_t i = 0; i < compilada.num_locais; i++) {
+        Operando slot = novoSlot();
+        if (i == 0) base = slot;
+    }
+    auto traduz = [&base](Operando operando) {
+        return operando.tipo == OPERANDO_LOCAL ? Operando{base.tipo, base.indice + operando.indice} : operando;
+    };
+
+    for (uint32_t i = 0; i < compilada.num_parametros; i++) {
+        emite({OP_COPIA, {base.tipo, base.indice + i}, argumentos_pendentes_[primeiro_argumento + i]});
+    }
+
+    // Onde cada instrução do corpo vai parar, para corrigir os saltos
+    std::array<uint32_t, LIMITE_EXPANSAO + 1> posicao;
+    uint32_t proxima = aqui();
+    for (uint32_t i = 0; i < tamanho; i++) {
+        posicao[i] = proxima;
+        const Instrucao& instrucao = programa_->codigo[compilada.inicio + i];
+        if (instrucao.op != OP_RETORNA) {
+            proxima++;
+            continue;
+        }
+        proxima += instrucao.a.tipo != OPERANDO_NENHUM && destino.tipo != OPERANDO_NENHUM;
+        proxima += i + 1 < tamanho; // o último return só cai no fim
+    }
+    posicao[tamanho] = proxima;
+
+    for (uint32_t i = 0; i < tamanho; i++) {
+        Instrucao instrucao = programa_->codigo[compilada.inicio + i]; // cópia: emite() pode realocar o código
+        bloco_atual_ = copia + (programa_->bloco_instrucao[compilada.inicio + i] - compilada.bloco);
+        instrucao.a = traduz(instrucao.a);
+        instrucao.b = traduz(instrucao.b);
+        switch (instrucao.op) {
+            case OP_RETORNA:
+                if (instrucao.a.tipo != OPERANDO_NENHUM && destino.tipo != OPERANDO_NENHUM) {
+                    emite({OP_COPIA, destino, instrucao.a});
+                }
+                if (i + 1 < tamanho) {
+                    emite({OP_SALTA, {}, {}, posicao[tamanho]});
+                }
+                break;
+            case OP_SALTA:
+            case OP_SALTA_SE_FALSO:
+                instrucao.n = posicao[instrucao.n - compilada.inicio];
+                emite(instrucao);
+                break;
+            default:
+                emite(instrucao);
+                break;
+        }
+    }
+    bloco_atual_ = bloco_externo;
+}
+
+Operando Parser::constante(const std::string& tipo) {
+    if (!programa_) return {};
+    programa_->constantes.push_back(valor_padrao(tipo));
+    return {OPERANDO_CONSTANTE, static_cast<uint32_t>(programa_->constantes.size() - 1)};
 }
\ No newline at end of file
@@ -1,26 +1,124 @@
 #pragma once
+#include <deque>
+#include <iostream>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include "alocacoes.hpp"
+#include "canal_tokens.hpp"
+#include "diagnostico.hpp"
+#include "programa.hpp"
 #include "token.hpp"
 
+// Assinatura de uma função declarada com 'func'
+struct Funcao {
+    std::string retorno;
+    std::vector<std::string> parametros; // tipos, na ordem da declaração
+    bool tem_retorno = false;
+    uint32_t indice = 0; // posição em Programa::funcoes, só com geração de código
+    uint32_t fim = 0;    // fim do corpo no código gerado
+    bool expansivel = false; // folha pequena: as chamadas copiam o corpo
+};
+
+// Variável num escopo; o operando só é usado com geração de código
+struct Simbolo {
+    std::string tipo;
+    Operando operando;
+};
+
+// O que um módulo expõe para quem o importa: as variáveis globais e as
+// funções declaradas nele mesmo (não as que ele importou). Operandos e
+// índices de função só valem no Programa em que o módulo foi gerado.
+struct InterfaceModulo {
+    std::vector<std::pair<std::string, Simbolo>> variaveis;
+    std::vector<std::pair<std::string, Funcao>> funcoes;
+};
+
+// Módulo lido durante a compilação, com o hash do conteúdo naquele momento
+struct DependenciaModulo {
+    std::string caminho; // canônico
+    uint64_t hash;
+};
+
+class CarregadorModulos;
+
 class Parser {
 public:
+    Parser();
     Parser(const std::vector<Token>& tokens);
+    Parser(std::vector<Token>&& tokens);
+    explicit Parser(CanalTokens& canal); // consome tokens de um Lexer em outra thread
     bool parse();
+    void reiniciar(std::vector<Token>& tokens);
+    // false: nada vai para stdout/stderr e os erros ficam em diagnosticos()
+    void usarSaida(bool verboso);
+    // Onde o modo com saída escreve; por padrão std::cout e std::cerr
+    void usarSaida(std::ostream& saida, std::ostream& erros);
+    const std::vector<Diagnostico>& diagnosticos() const;
+    // Habilita 'import'; caminhos são resolvidos a partir de `diretorio`
+    void usarModulos(CarregadorModulos* modulos, const std::string& diretorio);
+    InterfaceModulo interface() const;
+    const std::vector<DependenciaModulo>& dependencias() const;
+    // Com um Programa, parse() também gera o código dele enquanto valida.
+    // `expandir_folhas` troca chamadas a funções folha pequenas pelo corpo.
+    void usarPrograma(Programa* programa, bool expandir_folhas = true);
 
 private:
-    std::vector<std::unordered_map<std::string, std::string>> escopos_;
+    static constexpr uint32_t LIMITE_EXPANSAO = 8; // instruções no corpo de uma folha expandida
+
+    std::vector<std::unordered_map<std::string, Simbolo>> escopos_;
+    size_t profundidade_ = 0; // escopos ativos; os mapas além dele ficam para reuso
     std::vector<Token> tokens_;
     size_t pos_;
+    CanalTokens* canal_ = nullptr;
+    std::deque<Token> recebidos_; // tokens já lidos do canal
+    bool canal_esgotado_ = false;
+    std::unordered_map<std::string, Funcao> funcoes_;
+    Funcao* funcao_atual_ = nullptr; // função cujo corpo está sendo analisado
+    bool verboso_ = true;
+    std::ostream* saida_ = &std::cout;
+    std::ostream* erros_ = &std::cerr;
+    std::vector<Diagnostico> diagnosticos_;
+    CarregadorModulos* modulos_ = nullptr;
+    std::string diretorio_;
+    std::vector<DependenciaModulo> dependencias_; // todos os módulos importados, direta ou indiretamente
+    std::unordered_set<std::string> modulos_importados_; // caminhos canônicos dos imports deste arquivo
+    std::unordered_set<std::string> variaveis_importadas_;
+    std::unordered_set<std::string> funcoes_importadas_;
+    Programa* programa_ = nullptr;
+    bool expandir_folhas_ = true;
+    size_t escopo_funcao_ = 0; // primeiro escopo da função atual
+    size_t escopo_funcao_externa_ = 0; // primeiro escopo da função mais externa em análise
+    std::vector<Operando> argumentos_pendentes_; // das chamadas ainda sem OP_CHAMA
+    uint32_t bloco_atual_ = 0;  // bloco (Programa::blocos) do código emitido agora
+    int linha_comando_ = 0;     // linha do comando sendo traduzido
 
-    Token peek();
-    Token advance();
+    static const Token fim_;
+
+    const Token& peek();
+    const Token& peek_seguinte();
+    const Token& advance();
+    const Token& token_em(size_t i);
     bool match(TokenTipo tipo);
     void entrarEscopo();
     void sairEscopo();
     bool declararVariavel(const std::string& nome, const std::string& tipo);
+    bool declararVariavel(const std::string& nome, const Simbolo& simbolo); // já com slot, de um import
     bool variavelDeclarada(const std::string& nome);
-    std::string tipoVariavel(const std::string& nome);
+    const Simbolo* buscaVariavel(const std::string& nome);
+
+    // Geração de código; sem Programa não fazem nada
+    uint32_t emite(const Instrucao& instrucao);
+    uint32_t aqui() const;
+    void corrigeSalto(uint32_t instrucao); // a instrução salta para aqui()
+    Operando novoSlot();
+    Operando constante(const Token& literal);
+    Operando constante(const std::string& tipo); // valor inicial de uma variável sem '='
+    uint32_t abreBloco(const std::string& rotulo, int linha); // devolve o bloco anterior
+    void fechaBloco(uint32_t anterior, int linha);
+    void expandeChamada(const Funcao& funcao, size_t primeiro_argumento, Operando destino);
 
     bool parse_comando();
     bool parse_declaracao();
@@ -30,6 +128,50 @@ private:
     bool parse_while();
     bool parse_for();
     bool parse_func();
+    bool parse_return();
+    bool parse_import();
+    bool parse_chamada_comando();
+    bool parse_chamada(std::string& tipo, Operando destino);
+    bool parse_valor(std::string& tipo, Operando& operando);
+
+    // Escreve as partes direto no stream, sem montar uma std::string temporária.
+    // Sem saída, monta a mensagem e guarda como diagnóstico, na linha do
+    // último token consumido: o erro é sobre o que veio até ali, e o
+    // próximo token pode já estar numa linha seguinte.
+    template <typename... Partes>
+    void erro(const Partes&... partes) {
+        erroNaLinha(pos_ > 0 ? token_em(pos_ - 1).linha : peek().linha, partes...);
+    }
+
+    // Para quando o erro é o próprio token ainda não consumido
+    template <typename... Partes>
+    void erroNaLinha(int linha, const Partes&... partes) {
+        EscopoFase fase(FASE_DIAGNOSTICO);
+        if (verboso_) {
+            *erros_ << "\033[1;31mErro de sintaxe: ";
+            (*erros_ << ... << partes);
+            *erros_ << "\033[0m" << std::endl;
+            return;
+        }
+
+        Diagnostico diagnostico{DIAGNOSTICO_SINTATICO, linha, {}};
+        auto acrescenta = [&diagnostico](const auto& parte) {
+            if constexpr (std::is_arithmetic_v<std::decay_t<decltype(parte)>>) {
+                diagnostico.mensagem += std::to_string(parte);
+            } else {
+                diagnostico.mensagem += parte;
+            }
+        };
+        (acrescenta(partes), ...);
+        diagnosticos_.push_back(std::move(diagnostico));
+    }
 
-    void erro(const std::string& msg);
+    // Acompanhamento do que foi reconhecido, só no modo com saída
+    template <typename... Partes>
+    void anuncia(const Partes&... partes) {
+        if (verboso_) {
+            (*saida_ << ... << partes);
+            *saida_ << std::endl;
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "perfil.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+Perfil::Perfil(std::shared_ptr<const Programa> programa, std::chrono::microseconds intervalo)
+    : programa_(std::move(programa)), num_blocos_(programa_->blocos.size()) {
+    contextos_.push_back({0, 0, 0});
+    entradas_.assign(num_blocos_, 0);
+    instrucoes_.assign(num_blocos_, 0);
+    amostras_.assign(num_blocos_, 0);
+    execucoes_.assign(programa_->codigo.size(), 0);
+    entradas_[0] = 1;
+
+    if (intervalo > std::chrono::microseconds::zero()) {
+        amostrando_ = true;
+        amostrador_ = std::thread([this, intervalo] {
+            std::unique_lock<std::mutex> trava(trava_);
+            while (!parar_.wait_for(trava, intervalo, [this] { return parando_; })) {
+                amostra_pendente_.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+}
+
+Perfil::~Perfil() {
+    if (amostrador_.joinable()) {
+        {
+            std::lock_guard<std::mutex> trava(trava_);
+            parando_ = true;
+        }
+        parar_.notify_one();
+        amostrador_.join();
+    }
+}
+
+void Perfil::chamada(uint32_t pc, uint32_t indice_funcao) {
+    pilha_.push_back({contexto_, bloco_});
+    uint32_t funcao = programa_->funcoes[indice_funcao].bloco;
+
+    uint64_t chave = (static_cast<uint64_t>(contexto_) << 32) | pc;
+    auto it = filhos_.find(chave);
+    if (it == filhos_.end()) {
+        // Recursão: se a função já está na pilha, volta para o contexto dela
+        uint32_t destino = contexto_;
+        while (destino != 0 && contextos_[destino].funcao != funcao) {
+            destino = contextos_[destino].pai;
+        }
+        if (destino == 0) {
+            destino = static_cast<uint32_t>(contextos_.size());
+            contextos_.push_back({contexto_, bloco_, funcao});
+            entradas_.resize(entradas_.size() + num_blocos_);
+            instrucoes_.resize(instrucoes_.size() + num_blocos_);
+            amostras_.resize(amostras_.size() + num_blocos_);
+        }
+        it = filhos_.emplace(chave, destino).first;
+    }
+
+    contexto_ = it->second;
+    base_ = static_cast<size_t>(contexto_) * num_blocos_;
+    bloco_ = funcao;
+    entradas_[base_ + funcao]++;
+}
+
+void Perfil::retorno() {
+    auto [contexto, bloco] = pilha_.back();
+    pilha_.pop_back();
+    contexto_ = contexto;
+    base_ = static_cast<size_t>(contexto_) * num_blocos_;
+    bloco_ = bloco;
+}
+
+// `bloco` é o próprio `interno` ou um dos blocos que o contêm
+bool Perfil::contem(uint32_t bloco, uint32_t interno) const {
+    for (;;) {
+        if (interno == bloco) {
+            return true;
+        }
+        if (interno == 0) {
+            return false;
+        }
+        interno = programa_->blocos[interno].pai;
+    }
+}
+
+// Saltos dentro da mesma função: conta uma entrada em cada bloco entre o
+// ancestral comum e o bloco novo. Sair de um bloco não conta nada.
+void Perfil::muda_bloco(uint32_t bloco) {
+    for (uint32_t b = bloco; !contem(b, bloco_); b = programa_->blocos[b].pai) {
+        entradas_[base_ + b]++;
+    }
+    bloco_ = bloco;
+}
+
+void Perfil::amostra() {
+    amostra_pendente_.store(false, std::memory_order_relaxed);
+    amostras_[base_ + bloco_]++;
+}
+
+// "programa;while:5;func f:2": as funções da pilha de chamadas, cada uma
+// seguida dos blocos por onde a execução passou dentro dela
+std::string Perfil::caminho(uint32_t contexto, uint32_t bloco) const {
+    const Contexto& c = contextos_[contexto];
+    std::string resultado = contexto == 0 ? programa_->blocos[0].rotulo
+                                          : caminho(c.pai, c.bloco_chamada) + ";" + programa_->blocos[c.funcao].rotulo;
+
+    std::vector<uint32_t> internos;
+    for (uint32_t b = bloco; b != c.funcao && b != 0; b = programa_->blocos[b].pai) {
+        internos.push_back(b);
+    }
+    for (auto it = internos.rbegin(); it != internos.rend(); ++it) {
+        resultado += ";" + programa_->blocos[*it].rotulo;
+    }
+    return resultado;
+}
+
+void Perfil::escrever_folded(std::ostream& saida) const {
+    // Cópias de uma função expandida no mesmo bloco dão o mesmo caminho
+    const std::vector<uint64_t>& pesos = amostrando_ ? amostras_ : instrucoes_;
+    std::map<std::string, uint64_t> pilhas;
+    for (uint32_t contexto = 0; contexto < contextos_.size(); contexto++) {
+        for (uint32_t bloco = 0; bloco < num_blocos_; bloco++) {
+            uint64_t peso = pesos[contexto * num_blocos_ + bloco];
+            if (peso > 0) {
+                pilhas[caminho(contexto, bloco)] += peso;
+            }
+        }
+    }
+    for (const auto& [pilha, peso] : pilhas) {
+        saida << pilha << " " << peso << "\n";
+    }
+}
+
+void Perfil::escrever_relatorio(std::ostream& saida) const {
+    // Blocos somados em todas as pilhas de chamadas. As cópias de uma função
+    // expandida têm o mesmo rótulo e entram na mesma linha do relatório.
+    struct Total {
+        const BlocoFonte* bloco;
+        uint64_t entradas = 0;
+        uint64_t instrucoes = 0;
+        uint64_t amostras = 0;
+    };
+    std::vector<Total> totais;
+    std::unordered_map<std::string, size_t> por_rotulo;
+    for (size_t i = 0; i < entradas_.size(); i++) {
+        if (entradas_[i] == 0) {
+            continue;
+        }
+        const BlocoFonte& bloco = programa_->blocos[i % num_blocos_];
+        auto [it, novo] = por_rotulo.emplace(bloco.rotulo, totais.size());
+        if (novo) {
+            totais.push_back({&bloco});
+        }
+        Total& total = totais[it->second];
+        total.entradas += entradas_[i];
+        total.instrucoes += instrucoes_[i];
+        total.amostras += amostras_[i];
+    }
+    std::stable_sort(totais.begin(), totais.end(),
+                     [](const Total& a, const Total& b) { return a.instrucoes > b.instrucoes; });
+
+    // setw conta bytes: "ç" e "õ" ocupam dois
+    saida << std::left << std::setw(8) << "linha" << std::setw(13) << "execuções" << std::setw(14) << "instruções";
+    if (amostrando_) {
+        saida << std::setw(10) << "amostras";
+    }
+    saida << "bloco\n";
+    for (const Total& total : totais) {
+        saida << std::left << std::setw(8) << total.bloco->linha << std::setw(11) << total.entradas << std::setw(12)
+              << total.instrucoes;
+        if (amostrando_) {
+            saida << std::setw(10) << total.amostras;
+        }
+        saida << total.bloco->rotulo << "\n";
+    }
+
+    // Vezes que cada linha rodou: a instrução dela que mais executou
+    std::map<int, uint64_t> linhas;
+    for (size_t pc = 0; pc < execucoes_.size(); pc++) {
+        int linha = programa_->linha_instrucao[pc];
+        if (linha > 0 && execucoes_[pc] > 0) {
+            linhas[linha] = std::max(linhas[linha], execucoes_[pc]);
+        }
+    }
+    std::vector<std::pair<int, uint64_t>> mais_executadas(linhas.begin(), linhas.end());
+    std::stable_sort(mais_executadas.begin(), mais_executadas.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (mais_executadas.size() > 10) {
+        mais_executadas.resize(10);
+    }
+
+    saida << "\n" << std::setw(8) << "linha" << "execuções\n";
+    for (const auto& [linha, vezes] : mais_executadas) {
+        saida << std::left << std::setw(8) << linha << vezes << "\n";
+    }
+}
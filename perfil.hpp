@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "programa.hpp"
+
+// Perfil de execução de um Processo: quantas vezes cada bloco do programa
+// MacsLang (func, if/else, while, for) foi executado e quantas instruções
+// rodaram nele, separado por pilha de chamadas, e quantas vezes cada linha
+// rodou. Opcionalmente também amostra a pilha atual a cada `intervalo`.
+// O resultado pode ser gravado em formato "folded stacks" (flamegraph.pl,
+// speedscope) ou como relatório de texto ordenado.
+//
+// Só é usado por quem roda o Processo, uma thread por vez. Chamadas
+// recursivas são dobradas: a função que já está na pilha reaproveita o
+// contexto dela, então o número de pilhas distintas não cresce com a
+// profundidade da recursão.
+class Perfil {
+public:
+    explicit Perfil(std::shared_ptr<const Programa> programa,
+                    std::chrono::microseconds intervalo = std::chrono::microseconds::zero());
+    ~Perfil();
+    Perfil(const Perfil&) = delete;
+    Perfil& operator=(const Perfil&) = delete;
+
+    // Ganchos do interpretador, chamados só quando o perfil está ligado
+    void instrucao(uint32_t pc) {
+        execucoes_[pc]++;
+        uint32_t bloco = programa_->bloco_instrucao[pc];
+        if (bloco != bloco_) {
+            muda_bloco(bloco);
+        }
+        instrucoes_[base_ + bloco]++;
+        if (amostra_pendente_.load(std::memory_order_relaxed)) {
+            amostra();
+        }
+    }
+    void chamada(uint32_t pc, uint32_t funcao); // funcao: índice em Programa::funcoes
+    void retorno();
+
+    // Com amostragem, o peso de cada pilha é o número de amostras; sem, é o
+    // número de instruções executadas
+    void escrever_folded(std::ostream& saida) const;
+    void escrever_relatorio(std::ostream& saida) const;
+
+private:
+    // Contexto de chamada: a função chamada e o bloco de onde veio a chamada
+    struct Contexto {
+        uint32_t pai;
+        uint32_t bloco_chamada;
+        uint32_t funcao; // bloco do corpo da função; 0 na raiz
+    };
+
+    std::shared_ptr<const Programa> programa_;
+    size_t num_blocos_;
+
+    std::vector<Contexto> contextos_;
+    std::unordered_map<uint64_t, uint32_t> filhos_; // (contexto, pc da chamada) -> contexto
+    std::vector<std::pair<uint32_t, uint32_t>> pilha_; // contexto e bloco de quem chamou
+    uint32_t contexto_ = 0;
+    uint32_t bloco_ = 0;
+    size_t base_ = 0; // contexto_ * num_blocos_
+
+    // Indexados por contexto * num_blocos_ + bloco
+    std::vector<uint64_t> entradas_;
+    std::vector<uint64_t> instrucoes_;
+    std::vector<uint64_t> amostras_;
+    std::vector<uint64_t> execucoes_; // por instrução
+
+    // Amostragem: uma thread marca amostra_pendente_ a cada intervalo e a
+    // próxima instrução executada registra onde está
+    std::atomic<bool> amostra_pendente_{false};
+    bool amostrando_ = false;
+    std::mutex trava_;
+    std::condition_variable parar_;
+    bool parando_ = false;
+    std::thread amostrador_;
+
+    void muda_bloco(uint32_t bloco);
+    void amostra();
+    bool contem(uint32_t bloco, uint32_t interno) const;
+    std::string caminho(uint32_t contexto, uint32_t bloco) const;
+};
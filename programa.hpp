@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Valor de uma variável em execução (int, float, char, bool, string)
+using Valor = std::variant<int64_t, double, char, bool, std::string>;
+
+enum OpCode : uint8_t {
+    OP_COPIA,          // a <- b
+    OP_PRINT,          // escreve a
+    OP_INPUT,          // a <- próxima linha de entrada
+    OP_SALTA,          // pc <- n
+    OP_SALTA_SE_FALSO, // se a for falso, pc <- n
+    OP_CHAMA,          // a <- funcoes[n](argumentos[m...])
+    OP_RETORNA,        // devolve a (ou nada) para quem chamou
+    OP_FIM
+};
+
+enum TipoOperando : uint8_t {
+    OPERANDO_NENHUM,
+    OPERANDO_CONSTANTE,
+    OPERANDO_GLOBAL,
+    OPERANDO_LOCAL // relativo à base do quadro da função atual
+};
+
+struct Operando {
+    TipoOperando tipo = OPERANDO_NENHUM;
+    uint32_t indice = 0;
+};
+
+struct Instrucao {
+    OpCode op = OP_FIM;
+    Operando a = {};
+    Operando b = {};
+    uint32_t n = 0;
+    uint32_t m = 0;
+};
+
+// Bloco do código-fonte (func, if, else, while, for), para o perfil
+struct BlocoFonte {
+    std::string rotulo; // ex.: "while:29", "func saudacao:15"
+    int linha = 0;
+    uint32_t pai = 0;   // bloco que contém este; o 0 é o programa inteiro
+};
+
+struct FuncaoCompilada {
+    uint32_t inicio = 0;
+    uint32_t num_parametros = 0;
+    uint32_t num_locais = 0; // parâmetros, variáveis e temporários
+    uint32_t bloco = 0;      // bloco do corpo em Programa::blocos
+};
+
+// Programa traduzido pelo Parser (veja Parser::usarPrograma) para uma lista
+// plana de instruções enquanto valida o código. É imutável depois de
+// compilado, então vários Processos podem executar o mesmo Programa ao
+// mesmo tempo.
+struct Programa {
+    std::vector<Instrucao> codigo;
+    std::vector<Valor> constantes;
+    std::vector<Operando> argumentos; // operandos das chamadas, a partir de Instrucao::m
+    std::vector<FuncaoCompilada> funcoes;
+    uint32_t num_globais = 0;
+    uint32_t maior_quadro = 0; // maior num_locais entre as funções
+
+    // Origem de cada instrução de `codigo`: bloco e linha do comando que a
+    // gerou. Código de uma função expandida fica na linha da chamada.
+    std::vector<BlocoFonte> blocos;
+    std::vector<uint32_t> bloco_instrucao;
+    std::vector<int> linha_instrucao;
+};
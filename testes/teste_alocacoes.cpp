@@ -0,0 +1,97 @@
+// Verifica que, depois de aquecido, um Validador não aloca por token: valida
+// uma entrada válida gerada com N comandos e outra com 10N e compara as
+// alocações do lexer, do parser e dos escopos nas duas. Termina com código
+// diferente de zero se a diferença passar de um número fixo.
+//
+// Precisa da contabilidade de alocações. Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -DMACSLANG_CONTAR_ALOCACOES -I. testes/teste_alocacoes.cpp $(ls *.cpp | grep -v '^main.cpp$') -o teste_alocacoes
+//   ./teste_alocacoes [comandos=2000]
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "alocacoes.hpp"
+#include "lexer.hpp"
+#include "macslang.hpp"
+
+#ifndef MACSLANG_CONTAR_ALOCACOES
+#error "compile com -DMACSLANG_CONTAR_ALOCACOES"
+#endif
+
+namespace {
+
+// Alocações a mais permitidas na entrada 10x maior
+constexpr size_t FOLGA = 8;
+
+// Algumas globais e depois só comandos que não declaram nada, então o
+// número de nomes nos escopos não cresce com o tamanho da entrada
+std::string gera_programa(int comandos) {
+    std::string codigo =
+        "var c: bool = true;\n"
+        "var s: string = \"texto\";\n"
+        "var x: int = 42;\n"
+        "var f: float = 1.5;\n";
+    for (int i = 0; i < comandos; i++) {
+        switch (i % 4) {
+            case 0: codigo += "print(s);\n"; break;
+            case 1: codigo += "if (c) {\n    print(x);\n} else {\n    print(\"nao\");\n}\n"; break;
+            case 2: codigo += "while (c) {\n    input(c);\n    print(f);\n}\n"; break;
+            default: codigo += "print(1234);\n"; break;
+        }
+    }
+    return codigo;
+}
+
+struct Medida {
+    size_t alocacoes = 0;
+    size_t tokens = 0;
+    bool valido = false;
+};
+
+size_t alocacoes_compilador() {
+    return contagem_alocacoes(FASE_LEXER).alocacoes + contagem_alocacoes(FASE_PARSER).alocacoes +
+           contagem_alocacoes(FASE_ESCOPO).alocacoes;
+}
+
+Medida mede(macslang::Validador& validador, const std::string& codigo) {
+    Medida medida;
+    size_t antes = alocacoes_compilador();
+    medida.valido = validador.validar(codigo).valido;
+    medida.alocacoes = alocacoes_compilador() - antes;
+
+    Lexer lexer(codigo);
+    for (Token t = lexer.proximo_token(); t.tipo != FIM_ARQUIVO && t.tipo != ERRO; t = lexer.proximo_token()) {
+        medida.tokens++;
+    }
+    return medida;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int comandos = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::string pequeno = gera_programa(comandos);
+    std::string grande = gera_programa(comandos * 10);
+
+    // Duas vezes: o Parser troca o vetor de tokens com o do Validador, então
+    // cada um dos dois vetores precisa crescer uma vez
+    macslang::Validador validador;
+    validador.validar(grande);
+    validador.validar(grande);
+
+    Medida p = mede(validador, pequeno);
+    Medida g = mede(validador, grande);
+
+    std::cout << "tokens: " << p.tokens << " -> " << g.tokens << "\n";
+    std::cout << "alocações (lexer + parser + escopos): " << p.alocacoes << " -> " << g.alocacoes << "\n";
+
+    if (!p.valido || !g.valido) {
+        std::cerr << "entrada gerada não foi aceita\n";
+        return 1;
+    }
+    if (g.alocacoes > p.alocacoes + FOLGA) {
+        std::cerr << "alocações crescem com o número de tokens (folga: " << FOLGA << ")\n";
+        return 1;
+    }
+    std::cout << "ok\n";
+    return 0;
+}
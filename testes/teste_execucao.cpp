@@ -0,0 +1,146 @@
+// Compila e executa programas pequenos e compara a saída com a esperada, e
+// confere que a validação (macslang::validar) e a compilação para execução
+// aceitam e rejeitam os mesmos programas. Termina com código diferente de
+// zero se algum caso falhar.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. testes/teste_execucao.cpp $(ls *.cpp | grep -v '^main.cpp$') -o teste_execucao
+//   ./teste_execucao
+#include <iostream>
+#include <string>
+#include <vector>
+#include "interpretador.hpp"
+#include "macslang.hpp"
+
+namespace {
+
+struct Caso {
+    const char* nome;
+    const char* codigo;
+    std::vector<std::string> entradas; // uma linha por input
+    const char* saida;
+};
+
+const std::vector<Caso> CASOS = {
+    {"função não void que chega ao fim do corpo devolve o valor padrão",
+     "func f(x: int): string {\n"
+     "    if (x) {\n"
+     "        return \"a\";\n"
+     "    }\n"
+     "}\n"
+     "var s: string = f(0);\n"
+     "print(s);\n"
+     "input(s);\n"
+     "print(s);\n"
+     "var t: string = f(1);\n"
+     "print(t);\n",
+     {"hello"},
+     "\nhello\na\n"},
+    {"função declarada num bloco do topo enxerga as globais do bloco",
+     "var c: bool = true;\n"
+     "if (c) {\n"
+     "    var y: int = 7;\n"
+     "    func h(): void {\n"
+     "        print(y);\n"
+     "    }\n"
+     "    h();\n"
+     "}\n",
+     {},
+     "7\n"},
+};
+
+struct Concordancia {
+    const char* nome;
+    const char* codigo;
+    bool valido;
+};
+
+const std::vector<Concordancia> CONCORDANCIAS = {
+    {"local de uma função externa não é visível na função interna",
+     "func g(): void {\n"
+     "    var loc: int = 5;\n"
+     "    func h(): void {\n"
+     "        print(loc);\n"
+     "    }\n"
+     "    h();\n"
+     "}\n"
+     "g();\n",
+     false},
+    {"parâmetro de uma função externa não é visível na função interna",
+     "func g(p: int): void {\n"
+     "    func h(): void {\n"
+     "        print(p);\n"
+     "    }\n"
+     "}\n",
+     false},
+    {"global é visível em funções aninhadas",
+     "var x: int = 1;\n"
+     "func g(): void {\n"
+     "    func h(): void {\n"
+     "        print(x);\n"
+     "    }\n"
+     "    h();\n"
+     "}\n",
+     true},
+};
+
+bool concorda(const Concordancia& caso) {
+    bool validado = macslang::validar(std::span<const char>(caso.codigo, std::char_traits<char>::length(caso.codigo))).valido;
+    std::vector<Diagnostico> diagnosticos;
+    bool compilado = compilar(caso.codigo, diagnosticos) != nullptr;
+    if (validado != caso.valido || compilado != caso.valido) {
+        std::cerr << caso.nome << ": esperado " << (caso.valido ? "válido" : "inválido") << ", validação "
+                  << (validado ? "aceitou" : "rejeitou") << ", compilação " << (compilado ? "aceitou" : "rejeitou")
+                  << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Roda com e sem expansão de funções folha; os dois precisam dar a saída esperada
+bool executa(const Caso& caso, bool expandir) {
+    std::vector<Diagnostico> diagnosticos;
+    OpcoesCompilacao opcoes;
+    opcoes.expandir_folhas = expandir;
+    std::shared_ptr<const Programa> programa = compilar(caso.codigo, diagnosticos, opcoes);
+    if (!programa) {
+        std::cerr << caso.nome << ": não compilou\n";
+        for (const Diagnostico& d : diagnosticos) {
+            std::cerr << "  Linha " << d.linha << ": " << d.mensagem << "\n";
+        }
+        return false;
+    }
+
+    Processo processo(programa, 1000);
+    for (const std::string& linha : caso.entradas) {
+        processo.fornecer_entrada(linha);
+    }
+    while (processo.continuar() == PROCESSO_PRONTO) {
+    }
+
+    if (processo.estado() != PROCESSO_TERMINADO || !processo.erro().empty() || processo.saida() != caso.saida) {
+        std::cerr << caso.nome << (expandir ? "" : " (sem expansão)") << ": falhou\n"
+                  << "  esperado: " << caso.saida << "  obtido: " << processo.saida() << "  erro: " << processo.erro()
+                  << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    int falhas = 0;
+    for (const Caso& caso : CASOS) {
+        falhas += !executa(caso, true);
+        falhas += !executa(caso, false);
+    }
+    for (const Concordancia& caso : CONCORDANCIAS) {
+        falhas += !concorda(caso);
+    }
+    if (falhas > 0) {
+        return 1;
+    }
+    std::cout << "ok (" << CASOS.size() + CONCORDANCIAS.size() << " casos)\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Executa um programa que importa módulos: o código deles precisa estar no
+// Programa, cada módulo uma vez só mesmo importado por dois caminhos, e
+// importar de novo um módulo já importado (com outra grafia) não é erro.
+// Termina com código diferente de zero se a saída não for a esperada.
+//
+// Na raiz do repositório:
+//   g++ -std=c++20 -O2 -pthread -I. testes/teste_importacao.cpp $(ls *.cpp | grep -v '^main.cpp$') -o teste_importacao
+//   ./teste_importacao
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "interpretador.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void escreve(const fs::path& caminho, const std::string& conteudo) {
+    fs::create_directories(caminho.parent_path());
+    std::ofstream(caminho) << conteudo;
+}
+
+// Compila a partir de `diretorio` e roda até o fim; devolve false em erro
+bool executa(const std::string& codigo, const fs::path& diretorio, std::string& saida) {
+    std::vector<Diagnostico> diagnosticos;
+    OpcoesCompilacao opcoes;
+    opcoes.diretorio = diretorio.string();
+    std::shared_ptr<const Programa> programa = compilar(codigo, diagnosticos, opcoes);
+    if (!programa) {
+        for (const Diagnostico& d : diagnosticos) {
+            std::cerr << "Linha " << d.linha << ": " << d.mensagem << "\n";
+        }
+        return false;
+    }
+
+    Processo processo(programa, 1000);
+    while (processo.continuar() == PROCESSO_PRONTO) {
+    }
+    if (processo.estado() != PROCESSO_TERMINADO || !processo.erro().empty()) {
+        std::cerr << "Execução não terminou: " << processo.erro() << "\n";
+        return false;
+    }
+    saida = processo.saida();
+    return true;
+}
+
+} // namespace
+
+int main() {
+    fs::path diretorio = fs::temp_directory_path() / ("macslang_teste_importacao_" + std::to_string(std::random_device{}()));
+
+    escreve(diretorio / "lib" / "util.macslang",
+            "var saudacao: string = \"ola\";\n"
+            "print(\"carregando util\");\n"
+            "func eco(s: string): string {\n"
+            "    return s;\n"
+            "}\n"
+            "func mostra(s: string): void {\n"
+            "    print(s);\n"
+            "    print(saudacao);\n"
+            "}\n");
+    escreve(diretorio / "lib" / "a.macslang",
+            "import \"util.macslang\";\n"
+            "func dupla(s: string): void {\n"
+            "    mostra(s);\n"
+            "    mostra(eco(s));\n"
+            "}\n");
+
+    const std::string codigo =
+        "import \"lib/util.macslang\";\n"
+        "import \"lib/a.macslang\";\n"
+        "import \"lib/../lib/util.macslang\";\n"
+        "var x: string = \"mundo\";\n"
+        "dupla(x);\n"
+        "var y: string = eco(saudacao);\n"
+        "print(y);\n";
+    const std::string esperado = "carregando util\nmundo\nola\nmundo\nola\nola\n";
+
+    // A segunda vez já encontra os resumos gravados pela primeira
+    int falhas = 0;
+    for (int rodada = 1; rodada <= 2; rodada++) {
+        std::string saida;
+        if (!executa(codigo, diretorio, saida)) {
+            std::cerr << "rodada " << rodada << ": falhou ao compilar ou executar\n";
+            falhas++;
+        } else if (saida != esperado) {
+            std::cerr << "rodada " << rodada << ": saída inesperada:\n" << saida;
+            falhas++;
+        }
+    }
+
+    std::error_code ec;
+    fs::remove_all(diretorio, ec);
+
+    if (falhas > 0) {
+        return 1;
+    }
+    std::cout << "ok\n";
+    return 0;
+}
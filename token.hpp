@@ -1,11 +1,12 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 enum TokenTipo {
-    VAR, PRINT, INPUT, IF, ELSE, WHILE, FOR, FUNC,
+    VAR, PRINT, INPUT, IF, ELSE, WHILE, FOR, FUNC, RETURN, IMPORT,
     INT, FLOAT, CHAR, BOOL, STRING, VOID,
-    IDENTIFICADOR, NUMERO, TEXTO,
-    DOIS_PONTOS, IGUAL, PONTO_E_VIRGULA,
+    IDENTIFICADOR, NUMERO_INTEIRO, NUMERO_REAL, TEXTO,
+    DOIS_PONTOS, VIRGULA, IGUAL, PONTO_E_VIRGULA,
     ABRE_PARENTESE, FECHA_PARENTESE,
     ABRE_CHAVE, FECHA_CHAVE,
     FIM_ARQUIVO,
@@ -15,4 +16,7 @@ enum TokenTipo {
 struct Token {
     TokenTipo tipo;
     std::string valor;
+    int64_t inteiro = 0; // preenchido pelo lexer em NUMERO_INTEIRO
+    double real = 0.0;   // preenchido pelo lexer em NUMERO_REAL
+    int linha = 0;       // linha do código-fonte onde o token começa
 };
\ No newline at end of file
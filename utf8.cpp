@@ -0,0 +1,103 @@
+#include "utf8.hpp"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Quantos bytes seguidos a partir de `p` são ASCII (bit 7 zerado)
+size_t prefixo_ascii(const unsigned char* p, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= n; i += 16) {
+        __m128i bloco = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        int altos = _mm_movemask_epi8(bloco);
+        if (altos != 0) {
+            return i + __builtin_ctz(static_cast<unsigned>(altos));
+        }
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t palavra;
+        std::memcpy(&palavra, p + i, sizeof(palavra));
+        if (palavra & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+    while (i < n && p[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+} // namespace
+
+size_t valida_utf8(std::string_view texto) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(texto.data());
+    size_t n = texto.size();
+    size_t i = 0;
+
+    while (i < n) {
+        i += prefixo_ascii(p + i, n - i);
+        if (i == n) {
+            break;
+        }
+
+        unsigned char c = p[i];
+        size_t tamanho;
+        unsigned char min_segundo = 0x80;
+        unsigned char max_segundo = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            tamanho = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            tamanho = 3;
+            if (c == 0xE0) min_segundo = 0xA0; // forma longa demais
+            if (c == 0xED) max_segundo = 0x9F; // surrogates U+D800–U+DFFF
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            tamanho = 4;
+            if (c == 0xF0) min_segundo = 0x90; // forma longa demais
+            if (c == 0xF4) max_segundo = 0x8F; // acima de U+10FFFF
+        } else {
+            return i; // continuação solta, 0xC0/0xC1 ou 0xF5..0xFF
+        }
+
+        if (i + tamanho > n || p[i + 1] < min_segundo || p[i + 1] > max_segundo) {
+            return i;
+        }
+        for (size_t k = 2; k < tamanho; k++) {
+            if ((p[i + k] & 0xC0) != 0x80) {
+                return i;
+            }
+        }
+        i += tamanho;
+    }
+
+    return std::string_view::npos;
+}
+
+uint32_t decodifica_utf8(const char* p, size_t& tamanho) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    if (u[0] < 0x80) {
+        tamanho = 1;
+        return u[0];
+    }
+    if (u[0] < 0xE0) {
+        tamanho = 2;
+        return ((u[0] & 0x1Fu) << 6) | (u[1] & 0x3Fu);
+    }
+    if (u[0] < 0xF0) {
+        tamanho = 3;
+        return ((u[0] & 0x0Fu) << 12) | ((u[1] & 0x3Fu) << 6) | (u[2] & 0x3Fu);
+    }
+    tamanho = 4;
+    return ((u[0] & 0x07u) << 18) | ((u[1] & 0x3Fu) << 12) | ((u[2] & 0x3Fu) << 6) | (u[3] & 0x3Fu);
+}
+
+bool letra_unicode(uint32_t codigo) {
+    if (codigo >= 0x00C0 && codigo <= 0x02AF) {
+        return codigo != 0x00D7 && codigo != 0x00F7;
+    }
+    return codigo >= 0x0370 && codigo <= 0x04FF;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Devolve o deslocamento do primeiro byte que não forma UTF-8 válido, ou
+// std::string_view::npos se o texto inteiro for válido. Rejeita formas
+// longas demais, surrogates e pontos de código acima de U+10FFFF.
+size_t valida_utf8(std::string_view texto);
+
+// Decodifica a sequência que começa em `p`, que já deve ter passado por
+// valida_utf8, e guarda em `tamanho` quantos bytes ela ocupa.
+uint32_t decodifica_utf8(const char* p, size_t& tamanho);
+
+// Letras fora do ASCII aceitas em identificadores: latinas acentuadas
+// (U+00C0–U+02AF, sem × e ÷), gregas e cirílicas (U+0370–U+04FF)
+bool letra_unicode(uint32_t codigo);